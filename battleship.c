@@ -4,64 +4,31 @@
  * Battleship guesser written for Info Theory (20-21)
  * @created 12/21/20
  * 
+ * The interactive game and the headless simulator; moves are generated
+ * by libbattleship (solver.c).
+ * 
  * Todos [low priority]:
  * - Add options for different ship quantities/sizes
  * - Add input validation for ship sinkage prompt
  * - Add cmd line flags for program macros/constants
- * - Change MAX_CONFIGS_TESTED to a time constraint instead
  */
 
-/* ----- MACROS ----- */
-
-#define BOARD_SIDELENGTH 10 // side length of square battleship board. MAX 10
-#define BOARD_PADDING 4     // amount to pad on each side. should be equal to
-// the longest ship's length - 1
-#define DEBUG 1 // set to 1 to print debug messages, 0 otherwise
-
 /* ----- GLOBAL VARIABLES ----- */
 
-// max # of configs to test in each round of calculation
-int MAX_CONFIGS_TESTED = 10000000;
-
-/**
- * Board status
- * 0 = padding square
- * 1 = unguessed
- * 2 = missed
- * 3 = hit, not on a sunk ship
- * 4 = hit, on a sunk ship
- */
-int S[BOARD_SIDELENGTH + 2 * BOARD_PADDING][BOARD_SIDELENGTH + 2 * BOARD_PADDING];
-
-// keeps track of which ships are sunk
-// ship order: 2,3,3,4,5
-int sunken[5];
-// keeps track of where sunken ships are
-int sunkenLocations[5];
+// options every solver is created with (set by the command line flags)
+struct solverOptions options;
 
-// stores the valid ship orientations (sort of like a list)
-// stores numbers formatted as such: spot index * 10 + orientation
-// spot index is a number from 0 to 99
-// orientation is 0 or 1, depending on up or right orientation
-int shipConfigs[5][200];
-// stores the # of valid ship orientations for each ship
-int numShipConfigs[5];
-
-// an int-int map that stores if two ships will intersect in a specific configuration
-struct entry *shipCollisionMap;
-
-// an int-int map that stores the frequency of each ship position occuring
-// given the remaining board configurations possible
-struct entry *shipPositionFrequencyMap;
-
-// stores the current # of guesses
-int numGuesses;
+// result of one headless game
+struct gameResult
+{
+    int game;                                                   // index of the game
+    int won;                                                    // 1 if every ship was sunk
+    int guesses;                                                // # of guesses made
+    double latencies[BOARD_SIDELENGTH * BOARD_SIDELENGTH];      // ms taken by each move
+};
 
 /* ----- FUNCTION DECLARATIONS ----- */
 
-// Initializes important variables, memory, etc.
-void init(void);
-
 /* UI FUNCTIONS */
 
 // plays a game of battleship until forfeit or win
@@ -69,102 +36,165 @@ void playGame();
 // Prints the welcome screen
 int printWelcomeScreen();
 // Prints the current board status
-void printBoard(int board[BOARD_SIDELENGTH + 2 * BOARD_PADDING][BOARD_SIDELENGTH + 2 * BOARD_PADDING]);
+void printBoard(struct solver *);
 // Prompts for input from the user
-int promptInput();
-
-void promptGuess();
-
-void promptShipSinkage();
-
-/* MOVE GENERATION FUNCTIONS */
-
-// Overarching move generation function; returns an integer in [0,99]
-int generateMove(void);
-// Generates all valid configurations for each ship
-void generateShipConfigs(void);
-// Determines for all pairs of ship configs if the ships will collide
-void determineShipCollisions(void);
-// Returns if two ship configs collide (uses results from determineShipCollisions)
-int shipConfigsCollide(int, int, int, int);
-// tests if the given ship configuration is possible (given current board status)
-int validConfig(int[5]);
-// randomly tests MAX_CONFIGS_TESTED configs
-int randomlyTestConfigs();
-// brute force tests all possible configs
-int bruteForceTestConfigs();
-// calculates and returns the best move after all ship frequencies have been determined
-int calculateBestMove(int);
-
-/* HELPER/DEBUG FUNCTIONS */
-
-// returns a ship's length given its index
-// in order: 0,1,2,3,4 --> 2,3,3,4,5
-int shipLengthFromIndex(int);
-// Meant for testing generateShipConfigs and determineShipCollisions
-// Retrieves from determineShipCollision's map if two ships collide
-void testCollide(int, int, int, int, int, int, int, int);
+int promptInput(struct solver *);
+
+void promptGuess(struct solver *);
+
+void promptShipSinkage(struct solver *);
+
+/* SIMULATION FUNCTIONS */
+
+// plays the given # of games headlessly on the given # of threads and prints a report
+int simulateGames(int, int);
+// plays one game of simulateGames (threadpool task)
+void gameTask(int, int, void *);
+// plays one headless game against a random fleet
+void simulateGame(int, struct gameResult *);
+// draws a uniformly random legal fleet, storing a config index for each ship
+void placeRandomFleet(struct mtState *, int[5]);
+// fills in the squares of a ship config, returns the ship's length
+int configSquares(int, int, int[5]);
+// prints the guesses-to-win distribution, throughput and move latencies of the games
+void printSimulationReport(struct gameResult *, int, double, int);
 
 /* ----- CODE ----- */
 
 /**
  * Prints the welcome screen. According to the player's action,
  * plays the game or quits.
+ * 
+ * Flags:
+ * -t <n> use n threads to generate moves (default: # of cores)
+ * -s <n> seed the random number generators with n (default: the time)
+ * -b <ms> generate each move within a time budget of ms milliseconds
+ * -x count states too large to enumerate exactly instead of sampling them
+ *    (slower, and not bound by the time budget)
+ * -r sample (or enumerate) every move afresh instead of reusing the boards
+ *    found for the last one
+ * -o <file> play the moves of the opening book in file (see bookgen.c)
+ *    where it has them
+ * -c <n> cache the moves of up to n board states, shared by every game,
+ *    and report how often it was hit (see cache.c)
+ * -g <n> play n games against random fleets without any input, -t at a
+ *    time (one thread each), and report how they went
+ * -S serve many games at once over a line protocol on stdin/stdout, with
+ *    -t worker threads (one per move; see server.c)
+ * -q <n> let at most n moves wait for a worker in server mode (default: 64)
  */
-int main()
+int main(int argc, char *argv[])
 {
-    int inp1 = printWelcomeScreen();
-
-    if (inp1 == 1)
+    solverDefaultOptions(&options);
+    options.numThreads = defaultNumThreads();
+    options.randomSeed = time(0);
+    options.log = stdout;
+
+    // # of games to play headlessly, 0 to play interactively
+    int numGames = 0;
+    // 1 to run the server, and how many moves it lets wait
+    int serverMode = 0;
+    int queueCapacity = 64;
+    // the opening book, if any (shared by every solver)
+    struct openingBook *book = NULL;
+    // the move cache, if any (shared by every solver)
+    struct moveCache *cache = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "t:s:b:xro:c:g:Sq:")) != -1)
     {
-        playGame();
+        switch (opt)
+        {
+        case 't':
+            options.numThreads = atoi(optarg);
+            if (options.numThreads < 1)
+                options.numThreads = 1;
+            break;
+        case 's':
+            options.randomSeed = strtoul(optarg, NULL, 10);
+            break;
+        case 'b':
+            options.moveTimeBudgetMs = atoi(optarg);
+            if (options.moveTimeBudgetMs < 0)
+                options.moveTimeBudgetMs = 0;
+            break;
+        case 'x':
+            options.exactJoin = 1;
+            break;
+        case 'r':
+            options.reuseSamples = 0;
+            options.maxFleetsKept = 0;
+            break;
+        case 'o':
+            bookClose(book);
+            book = bookOpen(optarg);
+            if (book == NULL)
+            {
+                printf("Couldn't read the opening book %s\n", optarg);
+                return 1;
+            }
+            options.book = book;
+            break;
+        case 'c':
+            moveCacheDestroy(cache);
+            cache = moveCacheCreate(atoi(optarg));
+            if (cache == NULL)
+            {
+                printf("Couldn't allocate the move cache\n");
+                bookClose(book);
+                return 1;
+            }
+            options.cache = cache;
+            break;
+        case 'g':
+            numGames = atoi(optarg);
+            break;
+        case 'S':
+            serverMode = 1;
+            break;
+        case 'q':
+            queueCapacity = atoi(optarg);
+            if (queueCapacity < 1)
+                queueCapacity = 1;
+            break;
+        default:
+            printf("Usage: %s [-t threads] [-s seed] [-b budget ms] [-x] [-r] [-o book file] [-c cache size] [-g games] [-S [-q queue size]]\n", argv[0]);
+            bookClose(book);
+            moveCacheDestroy(cache);
+            return 1;
+        }
     }
-    else if (inp1 == 2)
+
+    int status = 0;
+    if (numGames > 0)
+        status = simulateGames(numGames, options.numThreads);
+    else if (serverMode)
     {
-        return 0;
+        // moves of different games run side by side, one thread each
+        struct solverOptions sessionOptions = options;
+        sessionOptions.numThreads = 1;
+        sessionOptions.log = NULL;
+        status = serve(&sessionOptions, options.numThreads, queueCapacity);
     }
     else
     {
-        printf("There was an error.\n");
-        return 1;
-    }
-
-    return 0;
-}
+        int inp1 = printWelcomeScreen();
 
-/**
- * Initializes necessary variables for the program
- */
-void init()
-{
-    // srand(time(0));
-    init_genrand(time(0));
-    numGuesses = 0;
-
-    // set all padding squares to 0 (padding)
-    for (int x = 0; x < BOARD_SIDELENGTH + 2 * BOARD_PADDING; x++)
-    {
-        for (int y = 0; y < BOARD_SIDELENGTH + 2 * BOARD_PADDING; y++)
-            S[x][y] = 0;
-    }
-    // set all board squares to 1 (unguessed)
-    for (int x = BOARD_PADDING; x < BOARD_SIDELENGTH + BOARD_PADDING; x++)
-    {
-        for (int y = BOARD_PADDING; y < BOARD_SIDELENGTH + BOARD_PADDING; y++)
-            S[x][y] = 1;
+        if (inp1 == 1)
+        {
+            playGame();
+        }
+        else if (inp1 != 2)
+        {
+            printf("There was an error.\n");
+            status = 1;
+        }
     }
-}
 
-/**
- * Determine if the game is won (all ships have been sunk)
- * @return 1 if won, 0 otherwise
- */
-int gameOver()
-{
-    for (int s = 0; s < 5; s++)
-        if (!sunken[s])
-            return 0;
-    return 1;
+    bookClose(book);
+    moveCacheDestroy(cache);
+
+    return status;
 }
 
 /**
@@ -172,22 +202,26 @@ int gameOver()
  */
 void playGame()
 {
-    init();
+    struct solver *solver = solverCreate(&options);
+    if (DEBUG)
+        printf("Ship configs and collisions generated\n");
 
     int quitGame = 0;
-    while (!gameOver() && !quitGame)
+    while (!solverGameOver(solver) && !quitGame)
     {
-        printBoard(S);
-        printf("Guesses so far: %d\n", numGuesses);
-        quitGame = promptInput(); // gets set to 1 when error
+        printBoard(solver);
+        printf("Guesses so far: %d\n", solverNumGuesses(solver));
+        quitGame = promptInput(solver); // gets set to 1 when error
     }
 
     if (quitGame)
     {
-        printf("Quit game at %d guesses.\n", numGuesses);
+        printf("Quit game at %d guesses.\n", solverNumGuesses(solver));
     }
     else
-        printf("Game over in %d guesses.\n", numGuesses);
+        printf("Game over in %d guesses.\n", solverNumGuesses(solver));
+
+    solverDestroy(solver);
 
     return;
 }
@@ -217,17 +251,16 @@ int printWelcomeScreen()
 /**
  * Prints the current board status as well as axis labels
  */
-void printBoard(int board[BOARD_SIDELENGTH + 2 * BOARD_PADDING][BOARD_SIDELENGTH + 2 * BOARD_PADDING])
+void printBoard(struct solver *solver)
 {
     printf("\n-----BOARD STATUS-----\n\n");
 
-    for (int y = BOARD_PADDING + BOARD_SIDELENGTH - 1; y >= BOARD_PADDING; y--)
+    for (int y = BOARD_SIDELENGTH - 1; y >= 0; y--)
     {
-        printf(" %-3d", y - BOARD_PADDING + 1);
-        for (int x = BOARD_PADDING; x < BOARD_PADDING + BOARD_SIDELENGTH; x++)
+        printf(" %-3d", y + 1);
+        for (int x = 0; x < BOARD_SIDELENGTH; x++)
         {
-            // printf("%d ", board[x][y]);
-            switch (board[y][x])
+            switch (solverSquare(solver, y * 10 + x))
             {
             case 1:
                 printf("%c ", '-');
@@ -258,7 +291,7 @@ void printBoard(int board[BOARD_SIDELENGTH + 2 * BOARD_PADDING][BOARD_SIDELENGTH
  * Prompts the user to select what they would like to input next in the game
  * @return 1 if the user quit the game, 0 otherwise
  */
-int promptInput()
+int promptInput(struct solver *solver)
 {
     printf("Press 1 for next guess.\nPress 2 to input ship sinkage.\nPress 3 to quit game.\n\n");
 
@@ -273,11 +306,11 @@ int promptInput()
 
     if (inp == 1)
     {
-        promptGuess();
+        promptGuess(solver);
     }
     else if (inp == 2)
     {
-        promptShipSinkage();
+        promptShipSinkage(solver);
     }
     else if (inp == 3)
     {
@@ -290,20 +323,24 @@ int promptInput()
 /**
  * Displays the next guess to the user and asks them if it was a hit or miss
  */
-void promptGuess()
+void promptGuess(struct solver *solver)
 {
-    numGuesses++;
-    // printf("...\n");
+    int move = solverNextMove(solver);
 
-    int move;
-    // if (numGuesses == 1)
-    //     move = 55; // Hardcode first move in (always the same)
-    // else
-    move = generateMove();
+#if TRACE
+    char tracePath[64];
+    snprintf(tracePath, sizeof(tracePath), "trace-move-%03d.json", solverNumGuesses(solver));
+    if (solverExportTrace(solver, tracePath) == 0)
+        printf("Trace written to %s\n", tracePath);
+#endif
 
     // Print the guess coordinates
-    printf("\nGuess %d: <%d, %d>\n", numGuesses, move % 10 + 1, move / 10 + 1);
+    printf("\nGuess %d: <%d, %d>\n", solverNumGuesses(solver), move % 10 + 1, move / 10 + 1);
     printf("Enter 1 for hit.\nEnter 2 for miss.\n");
+    fflush(stdout);
+
+    // work out the next move for both answers while waiting for this one
+    solverSpeculate(solver, move);
 
     int inp;
     scanf(" %d", &inp);
@@ -314,8 +351,7 @@ void promptGuess()
         scanf(" %d", &inp);
     }
 
-    // Set the square in the status matrix accordingly
-    S[BOARD_PADDING + move / 10][BOARD_PADDING + move % 10] = inp == 1 ? 3 : 2;
+    solverRecordGuess(solver, move, inp == 1);
 
     return;
 }
@@ -323,7 +359,7 @@ void promptGuess()
 /**
  * Prompts the user to input information for a sunken ship
  */
-void promptShipSinkage()
+void promptShipSinkage(struct solver *solver)
 {
     printf("Which ship was sunk? (Enter a number between 1-5)\n");
     printf("Note: ship order is 2, 3, 3, 4, 5.\n\n");
@@ -331,7 +367,7 @@ void promptShipSinkage()
     int s;
     scanf(" %d", &s);
 
-    while (s < 1 || s > 5 || sunken[s - 1])
+    while (s < 1 || s > 5 || solverShipSunk(solver, s - 1))
     {
         printf("Bad input or that ship has been sunk already, try again.\n");
         scanf(" %d", &s);
@@ -339,555 +375,284 @@ void promptShipSinkage()
 
     printf("What is the x-coordinate of the ship's left or bottom square?\n");
     int x;
-    scanf(" %d", &x); // todo: error checking
+    scanf(" %d", &x);
 
     printf("What is the y-coordinate of the ship's left or bottom square?\n");
     int y;
-    scanf(" %d", &y); // todo: error checking
+    scanf(" %d", &y);
 
     printf("Is the ship facing up or right? Enter 0 for up and 1 for right.\n");
     int o;
-    scanf(" %d", &o); // todo: error checking
+    scanf(" %d", &o);
 
-    // update the sunken arrays
-    sunken[s - 1] = 1;
-    sunkenLocations[s - 1] = (y - 1) * 100 + (x - 1) * 10 + o;
-
-    // set the square in the status matrix correctly
-    int shipLength = shipLengthFromIndex(s - 1);
-    if (o == 0)
-    { // facing up
-        for (int i = 0; i < shipLength; i++)
-        {
-            S[y + BOARD_PADDING - 1 + i][x + BOARD_PADDING - 1] = 4;
-        }
-    }
-    else if (o == 1)
-    { // facing right
-        for (int i = 0; i < shipLength; i++)
-        {
-            S[y + BOARD_PADDING - 1][x + BOARD_PADDING - 1 + i] = 4;
-        }
-    }
+    if (x < 1 || x > BOARD_SIDELENGTH || y < 1 || y > BOARD_SIDELENGTH || (o != 0 && o != 1) ||
+        solverRecordSinkage(solver, s - 1, (y - 1) * 100 + (x - 1) * 10 + o))
+        printf("That ship doesn't fit there, the sinkage was not recorded.\n");
 
     return;
 }
 
 /**
- * Generates all valid configs for each ship on the board
- * Iterates over every single square / every ship / every orientation (up or right)
+ * Plays games against random fleets without any input, answering each
+ * guess (and reporting each sunk ship) automatically, and prints a report
+ * 
+ * Every game has its own solver, so numWorkers games are played at once,
+ * one per thread (with one thread per move).
  * 
- * Because of the way the squares in the status matrix are set up, to see if
- * a ship configuration is valid the squares under the ship need to be
- * all odd numbers (either 1, unguessed, or 3, hit but not on a sunk ship).
- * This guarantees all generated ship configs don't go on missed squares or
- * hit but on a sunk ship squares.
+ * @param numGames # of games to play
+ * @param numWorkers # of threads
+ * @return 0, or 1 if the results couldn't be allocated
  */
-void generateShipConfigs(void)
+int simulateGames(int numGames, int numWorkers)
 {
-    if (DEBUG)
-        printf("Generating ship configs...\n");
-
-    // resetting numShipConfigs array
-    for (int i = 0; i < 5; i++)
-        numShipConfigs[i] = 0;
+    if (numWorkers > numGames)
+        numWorkers = numGames;
 
-    // ignores if ships have already been sunk (accounted for later)
-    for (int x = BOARD_PADDING; x < BOARD_SIDELENGTH + BOARD_PADDING; x++)
+    struct gameResult *results = calloc(numGames, sizeof(struct gameResult));
+    if (results == NULL)
     {
-        for (int y = BOARD_PADDING; y < BOARD_SIDELENGTH + BOARD_PADDING; y++)
-        {
-            // for each spot on the board
-
-            int indexMultiplied = ((y - BOARD_PADDING) * 10 + x - BOARD_PADDING) * 10; // index of the space in 0-99, *10
-
-            // testing 5 ship
-            /* up */ if ((S[y][x] * S[y + 1][x] * S[y + 2][x] * S[y + 3][x] * S[y + 4][x]) % 2 == 1)
-            {
-                shipConfigs[4][numShipConfigs[4]] = indexMultiplied + 0;
-                numShipConfigs[4]++;
-            }
-            /* right */ if ((S[y][x] * S[y][x + 1] * S[y][x + 2] * S[y][x + 3] * S[y][x + 4]) % 2 == 1)
-            {
-                shipConfigs[4][numShipConfigs[4]] = indexMultiplied + 1;
-                numShipConfigs[4]++;
-            }
-
-            // testing 4 ship
-            /* up */ if ((S[y][x] * S[y + 1][x] * S[y + 2][x] * S[y + 3][x]) % 2 == 1)
-            {
-                shipConfigs[3][numShipConfigs[3]] = indexMultiplied + 0;
-                numShipConfigs[3]++;
-            }
-            /* right */ if ((S[y][x] * S[y][x + 1] * S[y][x + 2] * S[y][x + 3]) % 2 == 1)
-            {
-                shipConfigs[3][numShipConfigs[3]] = indexMultiplied + 1;
-                numShipConfigs[3]++;
-            }
-
-            // testing 3 ships
-            /* up */ if ((S[y][x] * S[y + 1][x] * S[y + 2][x]) % 2 == 1)
-            {
-                // printf("up %d %d %d setting %d\n", y-4, x-4, indexMultiplied + 0, numShipConfigs[2]);
+        printf("Couldn't allocate the results of %d game(s)\n", numGames);
+        return 1;
+    }
 
-                shipConfigs[2][numShipConfigs[2]] = indexMultiplied + 0;
-                shipConfigs[1][numShipConfigs[1]] = indexMultiplied + 0;
-                numShipConfigs[2]++;
-                numShipConfigs[1]++;
-            }
-            /* right */ if ((S[y][x] * S[y][x + 1] * S[y][x + 2]) % 2 == 1)
-            {
-                // printf("right %d %d %d setting %d\n", y-4, x-4, indexMultiplied + 1, numShipConfigs[2]);
+    printf("Simulating %d game(s) on %d thread(s)...\n", numGames, numWorkers);
+    fflush(stdout);
 
-                shipConfigs[2][numShipConfigs[2]] = indexMultiplied + 1;
-                shipConfigs[1][numShipConfigs[1]] = indexMultiplied + 1;
-                numShipConfigs[2]++;
-                numShipConfigs[1]++;
-            }
+    double startTime = wallTime();
 
-            // testing 2 ship
-            /* up */ if ((S[y][x] * S[y + 1][x]) % 2 == 1)
-            {
-                shipConfigs[0][numShipConfigs[0]] = indexMultiplied + 0;
-                numShipConfigs[0]++;
-            }
-            /* right */ if ((S[y][x] * S[y][x + 1]) % 2 == 1)
-            {
-                shipConfigs[0][numShipConfigs[0]] = indexMultiplied + 1;
-                numShipConfigs[0]++;
-            }
-        }
-    }
+    runParallel(numWorkers, numGames, gameTask, results);
 
-    if (DEBUG)
-    {
-        printf("Printing # of valid ship configs:\n");
-        for (int i = 0; i < 5; i++)
-        {
-            printf("Ship %d: %d config(s)\n", i, numShipConfigs[i]);
-        }
-    }
+    printSimulationReport(results, numGames, wallTime() - startTime, numWorkers);
 
-    return;
-}
+    free(results);
 
-/**
- * Determines which ship configurations collide with each other
- * Iterates over each pair of 2 ship configurations and stores
- * setups that collide in a hashmap
- * 
- * This prevents the program from having to test the same pair
- * of configurations over and over again during the board
- * configuration generation phase
- */
-void determineShipCollisions(void)
-{
-    for (int s1 = 0; s1 < 5; s1++)
-    { // ship 1
-        for (int s2 = s1 + 1; s2 < 5; s2++)
-        { // ship 2
-            for (int c1 = 0; c1 < numShipConfigs[s1]; c1++)
-            { // iterate through ship 1 configs
-                for (int c2 = 0; c2 < numShipConfigs[s2]; c2++)
-                { // iterate through ship 2 configs
-
-                    int ship1Config = shipConfigs[s1][c1];
-                    int ship2Config = shipConfigs[s2][c2];
-
-                    if (shipConfigsCollide(s1, s2, ship1Config, ship2Config))
-                    {
-                        // add this to the hashmap for collisions
-                        int keyVal = s1 * 10000000 + s2 * 1000000 + ship1Config * 100 + ship2Config;
-                        put(keyVal, 67, shipCollisionMap);
-                    }
-                }
-            }
-        }
-    }
-    return;
+    return 0;
 }
 
 /**
- * Returns if two ships collide in a specific configuration
- * 
- * @param s1 index of the first ship
- * @param s2 index of the second ship
- * @param c1 config id of the first ship (y, x, o)
- * @param c2 config id of the second ship (y, x, o)
+ * Plays one game of simulateGames and prints how it went
  * 
- * @return 1 if the ships collide, 0 otherwise
+ * @param task index of the game
+ * @param thread index of the thread running the task
+ * @param arg the array of gameResults
  */
-int shipConfigsCollide(int s1, int s2, int c1, int c2)
+void gameTask(int task, int thread, void *arg)
 {
-    int x1 = (c1 / 10) % 10;
-    int y1 = c1 / 100;
-    int x2 = (c2 / 10) % 10;
-    int y2 = c2 / 100;
-
-    int o1 = c1 % 10;
-    int o2 = c2 % 10; // 0 (up) or 1 (right)
-
-    int ship1Length = shipLengthFromIndex(s1);
-    int ship2Length = shipLengthFromIndex(s2);
-
-    for (int l1 = 0; l1 < ship1Length; l1++)
-    { // compare each location of ship 1
-        for (int l2 = 0; l2 < ship2Length; l2++)
-        { // to each location of ship 2
+    struct gameResult *result = (struct gameResult *)arg + task;
 
-            int ship1Location = o1 == 1 ? y1 * 10 + x1 + l1 : (y1 + l1) * 10 + x1;
-            int ship2Location = o2 == 1 ? y2 * 10 + x2 + l2 : (y2 + l2) * 10 + x2;
+    simulateGame(task, result);
 
-            if (ship1Location == ship2Location)
-                return 1;
-        }
-    }
+    if (result->guesses == 0)
+        printf("Game %d: not played (out of memory)\n", result->game);
+    else
+        printf("Game %d: %s in %d guesses\n", result->game, result->won ? "won" : "lost track", result->guesses);
+    fflush(stdout);
 
-    return 0;
+    return;
 }
 
 /**
- * Returns the amount of configurations to be tested in a round
- * (AKA # of configs for each ship multiplied together)
+ * Plays one game against a random fleet (drawn from its own Mersenne
+ * Twister stream seeded from (the seed, game)), answering each guess
+ * and reporting a ship as sunk once all of its squares are hit
+ * 
+ * @param game index of the game
+ * @param result filled with the result of the game (lost in 0 guesses if
+ *               there isn't enough memory for a solver)
  */
-double numConfigsToBeTested()
+void simulateGame(int game, struct gameResult *result)
 {
-    double num = 1;
-    for (int i = 0; i < 5; i++)
+    struct solverOptions gameOptions = options;
+    gameOptions.numThreads = 1;
+    gameOptions.log = NULL;
+    struct solver *solver = solverCreate(&gameOptions);
+
+    result->game = game;
+    result->won = 0;
+    result->guesses = 0;
+    if (solver == NULL)
+        return;
+
+    struct mtState rng;
+    unsigned long key[2] = {options.randomSeed, (unsigned long)game};
+    init_by_array_r(&rng, key, 2);
+
+    int fleet[5];
+    placeRandomFleet(&rng, fleet);
+
+    // the ship on each square (-1 for none) and the # of squares of each ship not hit yet
+    int shipAt[BOARD_SIDELENGTH * BOARD_SIDELENGTH];
+    int squaresLeft[5];
+    for (int square = 0; square < BOARD_SIDELENGTH * BOARD_SIDELENGTH; square++)
+        shipAt[square] = -1;
+    for (int s = 0; s < 5; s++)
     {
-        if (!sunken[i]) num *= numShipConfigs[i];
+        int squares[5];
+        squaresLeft[s] = configSquares(s, solverShipConfig(s, fleet[s]), squares);
+        for (int l = 0; l < squaresLeft[s]; l++)
+            shipAt[squares[l]] = s;
     }
-    return num;
-}
-
-/**
- * Overall function for generating the next move
- */
-int generateMove(void)
-{
-    printf("Generating move...\n");
-
-    // initialize needed maps
-    shipCollisionMap = initializeHashmap();
-    shipPositionFrequencyMap = initializeHashmap();
-
-    generateShipConfigs();
-    if (DEBUG)
-        printf("Ship configs generated\n");
-
-    determineShipCollisions();
-    if (DEBUG)
-        printf("Ship collisions generated\n");
 
-    clock_t CPU_time_1 = clock(); // store START time
+    while (!solverGameOver(solver) && solverNumGuesses(solver) < BOARD_SIDELENGTH * BOARD_SIDELENGTH)
+    {
+        double startTime = wallTime();
+        int move = solverNextMove(solver);
+        result->latencies[solverNumGuesses(solver) - 1] = (wallTime() - startTime) * 1000;
 
-    int validConfigs = 0;
+#if TRACE
+        char tracePath[64];
+        snprintf(tracePath, sizeof(tracePath), "trace-game-%d-move-%03d.json", game, solverNumGuesses(solver));
+        solverExportTrace(solver, tracePath);
+#endif
 
-    double configsToBeTested = numConfigsToBeTested();
-    int totalTested;
+        // out of moves (the fleet should always be one of the valid boards)
+        if (move < 0 || solverRecordGuess(solver, move, shipAt[move] >= 0))
+            break;
 
-    if (configsToBeTested > MAX_CONFIGS_TESTED) {
-        if (DEBUG) printf("Randomly testing configs\n");
-        totalTested = MAX_CONFIGS_TESTED;
-        validConfigs = randomlyTestConfigs();
-    } else {
-        if (DEBUG) printf("Brute force testing configs\n");
-        totalTested = configsToBeTested;
-        validConfigs = bruteForceTestConfigs();
+        int hitShip = shipAt[move];
+        if (hitShip >= 0 && --squaresLeft[hitShip] == 0)
+            solverRecordSinkage(solver, hitShip, solverShipConfig(hitShip, fleet[hitShip]));
     }
 
-    clock_t CPU_time_2 = clock(); // store END time
-
-    printf("Time taken: %fs\n", ((double)(CPU_time_2 - CPU_time_1)) / CLOCKS_PER_SEC);
+    result->won = solverGameOver(solver);
+    result->guesses = solverNumGuesses(solver);
 
-    if (DEBUG) 
-        printf("\n# valid configs: %d out of %d\n", validConfigs, totalTested);
+    solverDestroy(solver);
 
-    int move = calculateBestMove(validConfigs);
-
-    if (DEBUG)
-        printf("\nBest move calculated, was %d\n", move);
-
-    // free memory :)
-    free(shipCollisionMap);
-    free(shipPositionFrequencyMap);
-
-    if (DEBUG)
-        printf("Maps freed, returning best move.\n");
-
-    return move;
+    return;
 }
 
 /**
- * Randomly generates and tests MAX_CONFIGS_TESTED configs
- * Used when the # of remaining configs is more than MAX_CONFIGS_TESTED
+ * Draws a uniformly random legal fleet: a uniformly random config for
+ * each ship, redrawn as a whole until no two ships overlap
+ * 
+ * @param rng the random number generator
+ * @param fleet filled with a config index (see solverShipConfig) for each ship
  */
-int randomlyTestConfigs()
+void placeRandomFleet(struct mtState *rng, int fleet[5])
 {
-    int validConfigs = 0;
-    for (int i = 0; i < MAX_CONFIGS_TESTED; i++)
+    int overlapping = 1;
+    while (overlapping)
     {
-
-        if (DEBUG && i % 1000000 == 0)
-            printf("Testing config %d\n", i);
-
-        int testedShipConfigs[5]; // randomly selected ship configs
-
-        // randomly select a config for each of the 5 ships (if not sunken)
-        for (int j = 0; j < 5; j++)
+        int occupied[BOARD_SIDELENGTH * BOARD_SIDELENGTH] = {0};
+        overlapping = 0;
+        for (int s = 0; s < 5; s++)
         {
-            int index = genrand_int32() % numShipConfigs[j];
-            if (!sunken[j])
-                testedShipConfigs[j] = shipConfigs[j][rand() % numShipConfigs[j]];
-            else
-                testedShipConfigs[j] = sunkenLocations[j];
-        }
+            fleet[s] = genrand_int32_r(rng) % solverNumShipConfigs(s);
 
-        // if the set of 5 generated ship configs is valid, add them to a
-        // hashmap denoting the frequency of each ship config
-        if (validConfig(testedShipConfigs))
-        {
-            validConfigs++;
-            for (int s = 0; s < 5; s++)
+            int squares[5];
+            int shipLength = configSquares(s, solverShipConfig(s, fleet[s]), squares);
+            for (int l = 0; l < shipLength; l++)
             {
-                int id = s * 1000 + testedShipConfigs[s];
-                int previousFrequency = get(id, shipPositionFrequencyMap);
-                if (previousFrequency == -1)
-                    put(id, 1, shipPositionFrequencyMap);
-                else
-                    put(id, previousFrequency + 1, shipPositionFrequencyMap);
+                if (occupied[squares[l]])
+                    overlapping = 1;
+                occupied[squares[l]] = 1;
             }
         }
     }
-    return validConfigs;
+
+    return;
 }
 
 /**
- * Brute force generates and tests all remaining configs
- * Used when the # of remaining configs is less than MAX_CONFIGS_TESTED
+ * Fills in the squares covered by a ship config
+ * 
+ * @param s index of the ship
+ * @param config config id of the ship (y, x, o)
+ * @param squares filled with the squares, from the bottom or left one
+ * @return the length of the ship
  */
-int bruteForceTestConfigs()
+int configSquares(int s, int config, int squares[5])
 {
+    int shipLength = shipLengthFromIndex(s);
+    for (int l = 0; l < shipLength; l++)
+        squares[l] = config / 10 + (config % 10 == 0 ? 10 * l : l);
 
-    int validConfigs = 0;
-
-    // stores the configs of each ship in the testing
-    int testedShipConfigs[5];
-
-    int numShipConfigsUpdated[5];
-    for(int i=0;i<5;i++) {
-        if (sunken[i]) numShipConfigsUpdated[i] = 1;
-        else numShipConfigsUpdated[i] = numShipConfigs[i];
-    }
-
-    // this is not a very good way to do this at all
-    for (int c1 = 0; c1 < numShipConfigsUpdated[0]; c1++)
-    {
-        if (sunken[0]) testedShipConfigs[0] = sunkenLocations[0];
-        else testedShipConfigs[0] = shipConfigs[0][c1];
-        for (int c2 = 0; c2 < numShipConfigsUpdated[1]; c2++)
-        {
-            if (sunken[1]) testedShipConfigs[1] = sunkenLocations[1];
-            else testedShipConfigs[1] = shipConfigs[1][c2];
-            for (int c3 = 0; c3 < numShipConfigsUpdated[2]; c3++)
-            {
-                if (sunken[2]) testedShipConfigs[2] = sunkenLocations[2];
-                else testedShipConfigs[2] = shipConfigs[2][c3];
-                for (int c4 = 0; c4 < numShipConfigsUpdated[3]; c4++)
-                {
-                    if (sunken[3]) testedShipConfigs[3] = sunkenLocations[3];
-                    else testedShipConfigs[3] = shipConfigs[3][c4];
-                    for (int c5 = 0; c5 < numShipConfigsUpdated[4]; c5++)
-                    {
-                        if (sunken[4]) testedShipConfigs[4] = sunkenLocations[4];
-                        else testedShipConfigs[4] = shipConfigs[4][c5];
-
-                        // if the set of 5 generated ship configs is valid, add them to a
-                        // hashmap denoting the frequency of each ship config
-                        if (validConfig(testedShipConfigs))
-                        {
-                            validConfigs++;
-                            for (int s = 0; s < 5; s++)
-                            {
-                                int id = s * 1000 + testedShipConfigs[s];
-                                int previousFrequency = get(id, shipPositionFrequencyMap);
-                                if (previousFrequency == -1)
-                                    put(id, 1, shipPositionFrequencyMap);
-                                else
-                                    put(id, previousFrequency + 1, shipPositionFrequencyMap);
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-    return validConfigs;
+    return shipLength;
 }
 
 /**
- * Given the configs of all 5 ships, tests to see if it is a valid board config
- * 1. Makes sure no ships are intersecting (using the map generated before)
- * 2. Makes sure all hit squares are covered
+ * Compares two doubles for qsort
  */
-int validConfig(int testedShipConfigs[5])
+static int compareDoubles(const void *a, const void *b)
 {
-    // Makes sure none of the ships intersect with each other
-    for (int s1 = 0; s1 < 5; s1++)
-    {
-        for (int s2 = s1 + 1; s2 < 5; s2++)
-        {
-            if (shipConfigsCollide(s1, s2, testedShipConfigs[s1], testedShipConfigs[s2]))
-                return 0;
-        }
-    }
-
-    // Stores which squares are covered by this board configuration
-    int coveredSquares[BOARD_SIDELENGTH * BOARD_SIDELENGTH];
-    for (int i = 0; i < BOARD_SIDELENGTH * BOARD_SIDELENGTH; i++)
-        coveredSquares[i] = 0;
-
-    for (int s = 0; s < 5; s++)
-    {
-
-        int currentCoord = testedShipConfigs[s] / 10;
-        int right = testedShipConfigs[s] % 10;
-
-        for (int l = 0; l < shipLengthFromIndex(s); l++)
-        {
-            coveredSquares[currentCoord] = 1;
-
-            if (right)
-                currentCoord++;
-            else
-                currentCoord += 10;
-        }
-    }
-
-    // Makes sure all hit (but not on a sunk ship) squares are covered
-    for (int x = BOARD_PADDING; x < BOARD_PADDING + BOARD_SIDELENGTH; x++)
-    {
-        for (int y = BOARD_PADDING; y < BOARD_PADDING + BOARD_SIDELENGTH; y++)
-        {
-            int spotID = 10 * (y - BOARD_PADDING) + x - BOARD_PADDING;
-            if (S[y][x] == 3 && coveredSquares[spotID] == 0)
-                return 0;
-        }
-    }
-
-    return 1;
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
 }
 
 /**
- * Now that the frequencies of each ship configuration have been calculated,
- * this function actually fills out the frequencies of each individual
- * square on the board and uses these values to find the best move.
+ * Prints the guesses-to-win distribution (in buckets of 5 guesses), the
+ * throughput and the per-move latency percentiles of the simulated games
  * 
- * Finds the square with # of hits closest to t/2
+ * @param results the results of the games
+ * @param numResults # of results
+ * @param seconds wall-clock time taken by all the games
+ * @param numWorkers # of threads the games were played on
  */
-int calculateBestMove(int totalTested)
+void printSimulationReport(struct gameResult *results, int numResults, double seconds, int numWorkers)
 {
-    int moveFrequencies[BOARD_SIDELENGTH * BOARD_SIDELENGTH];
-
-    for (int i = 0; i < BOARD_SIDELENGTH * BOARD_SIDELENGTH; i++)
-        moveFrequencies[i] = 0;
+    int numMoves = 0, numWon = 0, totalGuesses = 0;
+    int minGuesses = BOARD_SIDELENGTH * BOARD_SIDELENGTH, maxGuesses = 0;
+    int buckets[BOARD_SIDELENGTH * BOARD_SIDELENGTH / 5 + 1] = {0};
 
-    for (int s = 0; s < 5; s++)
+    for (int i = 0; i < numResults; i++)
     {
-        int numConfigs = numShipConfigs[s];
-        int shipLength = shipLengthFromIndex(s);
-        int shipMultiplied = s * 1000;
-
-        if (!sunken[s])
-        {
-            for (int c = 0; c < numConfigs; c++)
-            {
-
-                // ship index, y, x, orientation
-                int currConfig = shipConfigs[s][c];
-
-                int configFrequency = get(shipMultiplied + currConfig, shipPositionFrequencyMap);
+        numMoves += results[i].guesses;
+        if (!results[i].won)
+            continue;
 
-                int currentCoord = currConfig / 10;
-                int right = currConfig % 10;
-
-                if (configFrequency > 0)
-                {
-                    for (int l = 0; l < shipLength; l++)
-                    {
-                        moveFrequencies[currentCoord] += configFrequency;
-
-                        int x = currentCoord % 10;
-                        int y = currentCoord / 10;
-
-                        if (right)
-                            currentCoord++;
-                        else
-                            currentCoord += 10;
-                    }
-                }
-            }
-        }
+        numWon++;
+        totalGuesses += results[i].guesses;
+        buckets[results[i].guesses / 5]++;
+        if (results[i].guesses < minGuesses)
+            minGuesses = results[i].guesses;
+        if (results[i].guesses > maxGuesses)
+            maxGuesses = results[i].guesses;
     }
 
-    double targetHits = ((double) totalTested) / 2; // don't worry about truncation
-
-    int bestMove = -1;
-    double bestDifference = __INT_MAX__;
+    printf("\n-----SIMULATION REPORT-----\n\n");
+    printf("Games: %d played, %d won, %.2fs on %d thread(s)\n", numResults, numWon, seconds, numWorkers);
 
-    for (int i = 0; i < BOARD_SIDELENGTH * BOARD_SIDELENGTH; i++)
+    if (numWon > 0)
     {
-        // iterate through all unguessed squares
-        if (S[i / 10 + BOARD_PADDING][i % 10 + BOARD_PADDING] == 1)
+        printf("Guesses to win: mean %.2f, min %d, max %d\n", (double)totalGuesses / numWon, minGuesses, maxGuesses);
+        for (int b = minGuesses / 5; b <= maxGuesses / 5; b++)
         {
-            if (moveFrequencies[i] != 0) {
-                double diff = fabs(moveFrequencies[i] - targetHits);
-                if (diff < bestDifference)
-                {
-                    bestDifference = diff;
-                    bestMove = i;
-                }
-            }
+            printf(" %3d-%-3d %5d ", b * 5, b * 5 + 4, buckets[b]);
+            for (int i = 0; i < buckets[b] * 50 / numWon; i++)
+                printf("#");
+            printf("\n");
         }
     }
 
-    if (DEBUG) {
-        printf("Best difference: %f\n", bestDifference);
-    }
+    if (numMoves == 0)
+        return;
 
-    free(moveFrequencies);
+    double *latencies = malloc(numMoves * sizeof(double));
+    int n = 0;
+    for (int i = 0; i < numResults; i++)
+    {
+        for (int m = 0; m < results[i].guesses; m++)
+            latencies[n++] = results[i].latencies[m];
+    }
+    qsort(latencies, numMoves, sizeof(double), compareDoubles);
 
-    return bestMove;
-}
+    printf("Moves: %d, %.2f moves/s\n", numMoves, numMoves / seconds);
+    printf("Move latency (ms): p50 %.2f, p90 %.2f, p99 %.2f, max %.2f\n",
+           latencies[numMoves / 2], latencies[numMoves * 9 / 10], latencies[numMoves * 99 / 100], latencies[numMoves - 1]);
 
-int shipLengthFromIndex(int i)
-{
-    switch (i)
+    if (options.cache != NULL)
     {
-    case 0:
-        return 2;
-    case 1:
-        return 3;
-    case 2:
-        return 3;
-    case 3:
-        return 4;
-    case 4:
-        return 5;
+        struct moveCacheStats stats;
+        moveCacheGetStats(options.cache, &stats);
+        long long lookups = stats.hits + stats.misses;
+        printf("Move cache: %lld hit(s), %lld miss(es) (%.1f%% hit), %lld eviction(s), %d of %d state(s) kept\n",
+               stats.hits, stats.misses, lookups > 0 ? 100.0 * stats.hits / lookups : 0.0,
+               stats.evictions, stats.size, stats.capacity);
     }
-    printf("%d \n", i);
-    printf("Something has gone terribly wrong...\n");
-    return 0;
-}
-
-void testCollide(int x1, int y1, int x2, int y2, int s1, int s2, int o1, int o2)
-{
 
-    int ship1Config = y1 * 100 + x1 * 10 + o1;
-    int ship2Config = y2 * 100 + x2 * 10 + o2;
-    int keyVal = s1 * 10000000 + s2 * 1000000 + ship1Config * 100 + ship2Config;
-    printf("%d \n", get(keyVal, shipCollisionMap));
+    free(latencies);
 
     return;
-}
\ No newline at end of file
+}
+
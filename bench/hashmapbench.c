@@ -0,0 +1,116 @@
+/**
+ * Microbenchmark for hashmap.c: compares insert and lookup throughput
+ * of the open-addressing map against the old chained map
+ * (legacyhashmap.c) for a few map sizes.
+ * 
+ * Usage: ./bin/hashmapbench [# of lookups per size]
+ */
+
+#include <time.h>
+
+#include "../headers/hashmap.h"
+
+struct legacyEntry;
+struct legacyEntry *legacyInitializeHashmap();
+int legacyGet(int key, struct legacyEntry *map);
+void legacyPut(int key, int value, struct legacyEntry *map);
+void legacyDestroyHashmap(struct legacyEntry *map);
+
+// keeps the compiler from optimizing lookups away
+volatile long long sink;
+
+double wallTime(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * Fills keys with n distinct non-negative keys in random order
+ * (the legacy map can't hold negative keys)
+ */
+void makeKeys(int *keys, int n, unsigned int seed)
+{
+    srand(seed);
+    for (int i = 0; i < n; i++)
+        keys[i] = i * 7 + 3; // distinct
+    for (int i = n - 1; i > 0; i--)
+    {
+        int j = rand() % (i + 1);
+        int t = keys[i];
+        keys[i] = keys[j];
+        keys[j] = t;
+    }
+
+    return;
+}
+
+/**
+ * Prints millions of operations per second for one measurement
+ */
+void report(const char *map, const char *op, int n, long long ops, double seconds)
+{
+    printf("%-8s %-12s %8d keys %10.2f Mops/s\n", map, op, n, ops / seconds / 1e6);
+}
+
+int main(int argc, char *argv[])
+{
+    long long lookups = argc > 1 ? atoll(argv[1]) : 2000000;
+    int sizes[] = {100, 1000, 10000, 100000};
+
+    for (int si = 0; si < 4; si++)
+    {
+        int n = sizes[si];
+        int *keys = malloc(n * sizeof(int));
+        makeKeys(keys, n, si + 1);
+
+        // open addressing
+        double t0 = wallTime();
+        struct hashmap *map = hashmapCreate(0);
+        for (int i = 0; i < n; i++)
+            hashmapPut(map, keys[i], i);
+        double t1 = wallTime();
+        long long total = 0;
+        for (long long i = 0; i < lookups; i++)
+        {
+            long long value;
+            if (hashmapGet(map, keys[i % n], &value))
+                total += value;
+        }
+        double t2 = wallTime();
+        for (long long i = 0; i < lookups; i++)
+            total += hashmapGet(map, -1 - (int)(i % n), NULL); // misses
+        double t3 = wallTime();
+        sink = total;
+        hashmapDestroy(map);
+
+        report("robin", "insert", n, n, t1 - t0);
+        report("robin", "lookup hit", n, lookups, t2 - t1);
+        report("robin", "lookup miss", n, lookups, t3 - t2);
+
+        // legacy chained map
+        t0 = wallTime();
+        struct legacyEntry *legacy = legacyInitializeHashmap();
+        for (int i = 0; i < n; i++)
+            legacyPut(keys[i], i, legacy);
+        t1 = wallTime();
+        total = 0;
+        for (long long i = 0; i < lookups; i++)
+            total += legacyGet(keys[i % n], legacy);
+        t2 = wallTime();
+        for (long long i = 0; i < lookups; i++)
+            total += legacyGet(n * 7 + 3 + (int)(i % n) * 7, legacy); // misses
+        t3 = wallTime();
+        sink = total;
+        legacyDestroyHashmap(legacy);
+
+        report("legacy", "insert", n, n, t1 - t0);
+        report("legacy", "lookup hit", n, lookups, t2 - t1);
+        report("legacy", "lookup miss", n, lookups, t3 - t2);
+
+        free(keys);
+    }
+
+    return 0;
+}
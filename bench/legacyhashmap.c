@@ -0,0 +1,114 @@
+/**
+ * The chained int-int hashmap that hashmap.c used to be, kept only so
+ * that hashmapbench.c can compare against it. Two changes from the
+ * original, so that it can be benchmarked at all: chained entries are
+ * allocated on the heap (put used to link in the address of a stack
+ * variable), and legacyDestroyHashmap frees the chains.
+ */
+
+#include <stdlib.h>
+
+static int size = 1024; // size of 1 level of hashmap
+
+/**
+ * Knuth hash function
+ * @param a the integer number
+ */ 
+static int hash(int a) {         
+    return (a*2654435761) % size;
+}
+
+// pseudo-linked list 
+struct legacyEntry
+{
+    int key;          // unhashed int key
+    int val;          // value
+    struct legacyEntry *next; // next in the list
+};
+
+/**
+ * Allocates space for the map and initializes -1 values
+ */
+struct legacyEntry *legacyInitializeHashmap()
+{
+    struct legacyEntry *map; // entry array
+
+    map = malloc(size * sizeof(struct legacyEntry));
+
+    for (int i = 0; i < size; i++)
+    {
+        map[i].key = -1;;
+        map[i].next = NULL;
+    }
+
+    return map;
+}
+
+/**
+ * Adds an entry to the map (takes ownership of ent if it gets chained)
+ */
+static void addEntry(struct legacyEntry *ent, struct legacyEntry *map)
+{
+    int address = hash(ent->key);
+    struct legacyEntry *current = map + address;
+
+    // empty list, add key-value pair directly
+    if (current->key == -1) { map[address] = *ent; free(ent); }
+    else
+    {
+        // get to the tail of the list or the first matching key
+        while (current->next != NULL && ent->key != current->key) current = current->next;
+
+        // key exists, just replace the value
+        if (ent->key == current->key) { current->val = ent->val; free(ent); }
+        else current->next = ent; // otherwise concat it to the list
+    }
+
+    return;
+}
+
+int legacyGet(int key, struct legacyEntry *map)
+{
+    int address = hash(key);
+    struct legacyEntry *current = map + address;
+
+    int comparison = key - current->key;
+
+    while (current->next != NULL && comparison != 0)
+    {
+        current = current->next;
+        comparison = key - current->key;
+    }
+
+    return comparison == 0 ? current->val : -1;
+}
+
+void legacyPut(int key, int value, struct legacyEntry *map)
+{
+    struct legacyEntry *e = malloc(sizeof(struct legacyEntry));
+
+    e->key = key;
+    e->val = value;
+    e->next = NULL;
+
+    addEntry(e, map);
+
+    return;
+}
+
+void legacyDestroyHashmap(struct legacyEntry *map)
+{
+    for (int i = 0; i < size; i++)
+    {
+        struct legacyEntry *current = map[i].next;
+        while (current != NULL)
+        {
+            struct legacyEntry *next = current->next;
+            free(current);
+            current = next;
+        }
+    }
+    free(map);
+
+    return;
+}
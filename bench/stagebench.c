@@ -0,0 +1,231 @@
+/**
+ * Stage-level benchmark for the move generator: times each stage of
+ * generating a move separately on a few canned board states and prints
+ * the results as JSON, to track regressions across builds.
+ * 
+ * Stages: generateShipConfigs, determineShipCollisions,
+ * propagateShipConfigs, validConfig, randomlyTestConfigs,
+ * bruteForceTestConfigs (only on boards small enough to enumerate) and
+ * calculateBestMove. Each stage is repeated until it has run for at
+ * least MIN_STAGE_SECONDS (propagateShipConfigs only once, as it
+ * changes the board state).
+ * 
+ * Moves are generated on one thread with a fixed seed, so the counts and
+ * moves in the output are reproducible.
+ * 
+ * Usage: ./bin/stagebench [seed]
+ */
+
+#include "../headers/solver_internal.h"
+#include "../headers/mt.h"
+
+#include <string.h>
+
+#define MIN_STAGE_SECONDS 0.2  // min time each stage is repeated for
+#define NUM_VALID_CONFIG_CALLS 1000000 // # of validConfig calls per batch
+
+// a canned board state
+// rows[y][x] is the status of square <x, y>: '.' unguessed, 'X' missed,
+// 'O' hit, 'S' hit on a sunk ship; sunk[s] is the config id (y, x, o) of
+// ship s if it is sunk, -1 otherwise
+struct cannedBoard
+{
+    const char *name;
+    const char *rows[BOARD_SIDELENGTH];
+    int sunk[5];
+};
+
+// all the boards hold the same fleet: 2 at <0,0> right, 3 at <3,2> up,
+// 3 at <6,5> right, 4 at <8,0> up and 5 at <1,7> right
+struct cannedBoard boards[] = {
+    {"empty",
+     {"..........", "..........", "..........", "..........", "..........",
+      "..........", "..........", "..........", "..........", ".........."},
+     {-1, -1, -1, -1, -1}},
+    {"midgame",
+     {"..X..X....", "X...X.....", ".X.O..X...", "X.....X..X", "..X...X...",
+      "X..X.X.O..", ".X...X..X.", "X.....X...", "...X...X..", ".X...X...."},
+     {-1, -1, -1, -1, -1}},
+    {"hits",
+     {"..X..X.X.X", "X.X.X.X.O.", ".X.O.X.XO.", "X..O..X..X", ".X..X..X..",
+      "X.X.X.OO.X", ".X.X.X.X.X", "X.O...X.X.", ".X.X.X.X.X", "X.X.X.X.X."},
+     {-1, -1, -1, -1, -1}},
+    {"endgame",
+     {"SSX.X.X.SX", "X.X.X.X.S.", ".X.S.X.XS.", "X..S.X.XSX", ".X.S.X.X.X",
+      "X.X.X.SSSX", ".X.X.X.X.X", "X.OO..X.X.", ".X.X.X.X.X", "X.X.X.X.X."},
+     {1, 230, 561, 80, -1}},
+};
+
+// output of the benchmark
+FILE *out;
+
+// the solver the stages run on
+struct solver *solver;
+
+// index tuples for the validConfig stage
+int (*validConfigArgs)[5];
+
+// results of the last randomlyTestConfigs / bruteForceTestConfigs call
+long long lastValidConfigs;
+
+/**
+ * Sets the board up in the given state, as if the guesses had been
+ * recorded during a game and the next one was being generated
+ */
+void loadBoard(struct cannedBoard *board)
+{
+    int status[BOARD_SIDELENGTH * BOARD_SIDELENGTH];
+    for (int y = 0; y < BOARD_SIDELENGTH; y++)
+    {
+        for (int x = 0; x < BOARD_SIDELENGTH; x++)
+        {
+            const char *statuses = ".XOS";
+            status[y * 10 + x] = 1 + (int)(strchr(statuses, board->rows[y][x]) - statuses);
+        }
+    }
+
+    if (solverLoadBoard(solver, status, board->sunk))
+        fprintf(stderr, "Board %s is invalid\n", board->name);
+    countGuess(solver);
+
+    return;
+}
+
+void runGenerateShipConfigs(void)
+{
+    generateShipConfigs();
+}
+
+void runDetermineShipCollisions(void)
+{
+    determineShipCollisions();
+}
+
+void runPropagateShipConfigs(void)
+{
+    propagateShipConfigs(solver);
+}
+
+void runValidConfig(void)
+{
+    int valid = 0;
+    for (int i = 0; i < NUM_VALID_CONFIG_CALLS; i++)
+        valid += validConfig(solver, validConfigArgs[i]);
+    lastValidConfigs = valid;
+}
+
+void runRandomlyTestConfigs(void)
+{
+    lastValidConfigs = randomlyTestConfigs(solver);
+}
+
+void runBruteForceTestConfigs(void)
+{
+    lastValidConfigs = bruteForceTestConfigs(solver);
+}
+
+void runCalculateBestMove(void)
+{
+    calculateBestMove(solver, lastValidConfigs);
+}
+
+/**
+ * Times a stage and prints it as a JSON member: the # of calls and the
+ * mean seconds per call
+ * 
+ * @param name name of the stage
+ * @param stage runs the stage once (or a batch of calls)
+ * @param batch # of calls stage makes each time
+ * @param once 1 to run the stage only once
+ * @param last 1 if this is the last member of the object
+ */
+void timeStage(const char *name, void (*stage)(void), int batch, int once, int last)
+{
+    long long calls = 0;
+    double startTime = wallTime(), seconds = 0;
+    do
+    {
+        stage();
+        calls += batch;
+        seconds = wallTime() - startTime;
+    } while (!once && seconds < MIN_STAGE_SECONDS);
+
+    fprintf(out, "        \"%s\": {\"calls\": %lld, \"seconds_per_call\": %.9f}%s\n",
+            name, calls, seconds / calls, last ? "" : ",");
+
+    return;
+}
+
+int main(int argc, char *argv[])
+{
+    struct solverOptions options;
+    solverDefaultOptions(&options);
+    options.randomSeed = argc > 1 ? strtoul(argv[1], NULL, 10) : 1;
+    // every repetition of a stage draws its samples (and enumerates its boards) afresh
+    options.reuseSamples = 0;
+    options.maxFleetsKept = 0;
+    solver = solverCreate(&options);
+
+    out = stdout;
+
+    validConfigArgs = malloc(NUM_VALID_CONFIG_CALLS * sizeof(*validConfigArgs));
+
+    int numBoards = sizeof(boards) / sizeof(boards[0]);
+
+    fprintf(out, "{\n  \"seed\": %lu,\n  \"threads\": %d,\n  \"boards\": [\n", options.randomSeed, options.numThreads);
+
+    for (int b = 0; b < numBoards; b++)
+    {
+        loadBoard(&boards[b]);
+
+        fprintf(out, "    {\n      \"name\": \"%s\",\n      \"stages\": {\n", boards[b].name);
+
+        timeStage("generateShipConfigs", runGenerateShipConfigs, 1, 0, 0);
+        timeStage("determineShipCollisions", runDetermineShipCollisions, 1, 0, 0);
+        timeStage("propagateShipConfigs", runPropagateShipConfigs, 1, 1, 0);
+
+        // random (seeded) tuples of valid configs, as drawn by the sampler
+        struct mtState rng;
+        init_genrand_r(&rng, options.randomSeed);
+        for (int i = 0; i < NUM_VALID_CONFIG_CALLS; i++)
+        {
+            for (int s = 0; s < 5; s++)
+            {
+                validConfigArgs[i][s] = solverShipSunk(solver, s) ? 0 : validShipConfig(solver, s, genrand_int32_r(&rng) % numValidConfigs(solver, s));
+            }
+        }
+        timeStage("validConfig", runValidConfig, NUM_VALID_CONFIG_CALLS, 0, 0);
+
+        timeStage("randomlyTestConfigs", runRandomlyTestConfigs, 1, 0, 0);
+        long long sampledConfigs = lastValidConfigs;
+
+        double product = numConfigsToBeTested(solver);
+        long long enumeratedConfigs = -1;
+        if (product <= options.maxConfigsEnumerated)
+        {
+            timeStage("bruteForceTestConfigs", runBruteForceTestConfigs, 1, 0, 0);
+            enumeratedConfigs = lastValidConfigs;
+        }
+
+        timeStage("calculateBestMove", runCalculateBestMove, 1, 0, 1);
+        int move = calculateBestMove(solver, lastValidConfigs);
+
+        fprintf(out, "      },\n");
+        fprintf(out, "      \"configs_to_be_tested\": %.0f,\n", product);
+        fprintf(out, "      \"sampled_valid_configs\": %lld,\n", sampledConfigs);
+        if (enumeratedConfigs >= 0)
+            fprintf(out, "      \"enumerated_valid_configs\": %lld,\n", enumeratedConfigs);
+        else
+            fprintf(out, "      \"enumerated_valid_configs\": null,\n");
+        fprintf(out, "      \"best_move\": %d\n", move);
+        fprintf(out, "    }%s\n", b == numBoards - 1 ? "" : ",");
+    }
+
+    fprintf(out, "  ]\n}\n");
+    fflush(out);
+
+    free(validConfigArgs);
+    solverDestroy(solver);
+
+    return 0;
+}
@@ -0,0 +1,310 @@
+/**
+ * Opening book: the moves of the first few positions of a game, solved
+ * offline (by bookgen, with far more samples than a move can afford) so
+ * that the solver can play them without any search.
+ * 
+ * A book file is a small header followed by a sorted array of bookEntry,
+ * which bookOpen maps into memory as is: a lookup is a binary search
+ * over the mapped file, and any number of solvers (on any thread) can
+ * share one book.
+ * 
+ * The board and the fleet look the same under the 8 symmetries of the
+ * square (the rotations and reflections), so each position is stored
+ * once, in the form whose key (hits, then misses) is the smallest, with
+ * its move in that form; a lookup brings the position to the same form
+ * and maps the move back.
+ */
+
+#include "./headers/book.h"
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define BOOK_MAGIC "BSBK"
+#define BOOK_VERSION 1
+#define BOOK_SIDELENGTH 10          // side length of the board (see BOARD_SIDELENGTH)
+#define MOVE_SHIFT 56               // the move is stored in hits[1] from this bit on
+#define KEY_MASK ((1ULL << MOVE_SHIFT) - 1)
+
+// what comes before the entries in a book file
+struct bookHeader
+{
+    char magic[4];          // BOOK_MAGIC
+    uint32_t version;       // BOOK_VERSION
+    uint64_t numEntries;
+};
+
+struct openingBook
+{
+    void *map;                      // the mapped file
+    size_t mapSize;
+    const struct bookEntry *entries;
+    long long numEntries;
+};
+
+// returns the square a square is moved to by symmetry t
+static int transformSquare(int, int);
+// returns the square moved to the given one by symmetry t
+static int untransformSquare(int, int);
+// moves every square of a mask by symmetry t
+static void transformMask(int, const uint64_t[2], uint64_t[2]);
+// finds the symmetry giving the smallest key, and fills in the position it gives
+static int canonicalForm(const uint64_t[2], const uint64_t[2], uint64_t[2], uint64_t[2]);
+// orders positions by key (hits, then misses), ignoring the moves
+static int compareKeys(const uint64_t[2], const uint64_t[2], const uint64_t[2], const uint64_t[2]);
+// compares two bookEntries by key (for qsort)
+static int compareEntries(const void *, const void *);
+
+/**
+ * Maps a book file into memory
+ * 
+ * @param path the book file (written by bookWrite)
+ * @return the book, or NULL if it can't be read or isn't a book file
+ */
+struct openingBook *bookOpen(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat info;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size >= (off_t)sizeof(struct bookHeader))
+        map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return NULL;
+
+    const struct bookHeader *header = map;
+    if (memcmp(header->magic, BOOK_MAGIC, 4) != 0 || header->version != BOOK_VERSION ||
+        header->numEntries != (info.st_size - sizeof(struct bookHeader)) / sizeof(struct bookEntry))
+    {
+        munmap(map, info.st_size);
+        return NULL;
+    }
+
+    struct openingBook *book = malloc(sizeof(struct openingBook));
+    if (book == NULL)
+    {
+        munmap(map, info.st_size);
+        return NULL;
+    }
+    book->map = map;
+    book->mapSize = info.st_size;
+    book->entries = (const struct bookEntry *)(header + 1);
+    book->numEntries = header->numEntries;
+
+    return book;
+}
+
+/**
+ * Unmaps a book (no solver may use it any more)
+ */
+void bookClose(struct openingBook *book)
+{
+    if (book == NULL)
+        return;
+
+    munmap(book->map, book->mapSize);
+    free(book);
+}
+
+/**
+ * Returns the # of positions in a book
+ */
+long long bookSize(const struct openingBook *book)
+{
+    return book->numEntries;
+}
+
+/**
+ * Looks up the move of a position (with no ship sunk)
+ * 
+ * @param hits the hit squares (bit y * 10 + x, low word first)
+ * @param misses the missed squares
+ * @return the square to guess, or -1 if the position isn't in the book
+ */
+int bookLookup(const struct openingBook *book, const uint64_t hits[2], const uint64_t misses[2])
+{
+    uint64_t keyHits[2], keyMisses[2];
+    int t = canonicalForm(hits, misses, keyHits, keyMisses);
+
+    long long low = 0, high = book->numEntries - 1;
+    while (low <= high)
+    {
+        long long mid = low + (high - low) / 2;
+        const struct bookEntry *entry = book->entries + mid;
+        int order = compareKeys(entry->hits, entry->misses, keyHits, keyMisses);
+        if (order == 0)
+            return untransformSquare(t, entry->hits[1] >> MOVE_SHIFT);
+        if (order < 0)
+            low = mid + 1;
+        else
+            high = mid - 1;
+    }
+
+    return -1;
+}
+
+/**
+ * Fills in the book entry of a position and its move
+ * 
+ * @param hits the hit squares (bit y * 10 + x, low word first)
+ * @param misses the missed squares
+ * @param move the square to guess
+ */
+void bookMakeEntry(struct bookEntry *entry, const uint64_t hits[2], const uint64_t misses[2], int move)
+{
+    int t = canonicalForm(hits, misses, entry->hits, entry->misses);
+    entry->hits[1] |= (uint64_t)transformSquare(t, move) << MOVE_SHIFT;
+}
+
+/**
+ * Writes a book file: the entries, sorted and with the repeated positions
+ * dropped (one of them is kept, any of their moves will do)
+ * 
+ * @param entries the entries (sorted in place)
+ * @param numEntries # of entries
+ * @return 0 on success, 1 if the file couldn't be written
+ */
+int bookWrite(const char *path, struct bookEntry *entries, long long numEntries)
+{
+    qsort(entries, numEntries, sizeof(struct bookEntry), compareEntries);
+    long long numKept = 0;
+    for (long long e = 0; e < numEntries; e++)
+    {
+        if (numKept > 0 && compareEntries(entries + numKept - 1, entries + e) == 0)
+            continue;
+        entries[numKept++] = entries[e];
+    }
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+        return 1;
+
+    struct bookHeader header = {BOOK_MAGIC, BOOK_VERSION, numKept};
+    int failed = fwrite(&header, sizeof(header), 1, file) != 1 ||
+                 (long long)fwrite(entries, sizeof(struct bookEntry), numKept, file) != numKept;
+    failed |= fclose(file) != 0;
+
+    return failed;
+}
+
+/**
+ * Returns the square <x, y> is moved to by symmetry t: bit 2 of t swaps
+ * x and y, then bit 0 mirrors x and bit 1 mirrors y
+ */
+static int transformSquare(int t, int square)
+{
+    int x = square % BOOK_SIDELENGTH, y = square / BOOK_SIDELENGTH;
+    if (t & 4)
+    {
+        int swap = x;
+        x = y;
+        y = swap;
+    }
+    if (t & 1)
+        x = BOOK_SIDELENGTH - 1 - x;
+    if (t & 2)
+        y = BOOK_SIDELENGTH - 1 - y;
+
+    return y * BOOK_SIDELENGTH + x;
+}
+
+/**
+ * Returns the square moved to the given one by symmetry t (the inverse
+ * of transformSquare)
+ */
+static int untransformSquare(int t, int square)
+{
+    int x = square % BOOK_SIDELENGTH, y = square / BOOK_SIDELENGTH;
+    if (t & 1)
+        x = BOOK_SIDELENGTH - 1 - x;
+    if (t & 2)
+        y = BOOK_SIDELENGTH - 1 - y;
+    if (t & 4)
+    {
+        int swap = x;
+        x = y;
+        y = swap;
+    }
+
+    return y * BOOK_SIDELENGTH + x;
+}
+
+/**
+ * Moves every square of a mask by symmetry t
+ */
+static void transformMask(int t, const uint64_t in[2], uint64_t out[2])
+{
+    out[0] = out[1] = 0;
+    for (int w = 0; w < 2; w++)
+    {
+        for (uint64_t bits = in[w] & (w == 1 ? KEY_MASK : ~0ULL); bits; bits &= bits - 1)
+        {
+            int square = transformSquare(t, w * 64 + __builtin_ctzll(bits));
+            out[square / 64] |= 1ULL << (square % 64);
+        }
+    }
+}
+
+/**
+ * Finds the symmetry that gives a position its smallest key
+ * 
+ * @param hits, misses the position
+ * @param keyHits, keyMisses filled in with the position under that symmetry
+ * @return the symmetry
+ */
+static int canonicalForm(const uint64_t hits[2], const uint64_t misses[2], uint64_t keyHits[2], uint64_t keyMisses[2])
+{
+    int best = 0;
+    transformMask(0, hits, keyHits);
+    transformMask(0, misses, keyMisses);
+
+    for (int t = 1; t < 8; t++)
+    {
+        uint64_t tHits[2], tMisses[2];
+        transformMask(t, hits, tHits);
+        transformMask(t, misses, tMisses);
+        if (compareKeys(tHits, tMisses, keyHits, keyMisses) < 0)
+        {
+            best = t;
+            memcpy(keyHits, tHits, sizeof(tHits));
+            memcpy(keyMisses, tMisses, sizeof(tMisses));
+        }
+    }
+
+    return best;
+}
+
+/**
+ * Orders two positions by hits, then misses (high word first), ignoring
+ * the moves stored with them
+ * 
+ * @return < 0, 0 or > 0 as the first one comes before, is the same as or
+ *         comes after the second
+ */
+static int compareKeys(const uint64_t hitsA[2], const uint64_t missesA[2], const uint64_t hitsB[2], const uint64_t missesB[2])
+{
+    uint64_t a[4] = {hitsA[1] & KEY_MASK, hitsA[0], missesA[1], missesA[0]};
+    uint64_t b[4] = {hitsB[1] & KEY_MASK, hitsB[0], missesB[1], missesB[0]};
+    for (int i = 0; i < 4; i++)
+    {
+        if (a[i] != b[i])
+            return a[i] < b[i] ? -1 : 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Compares two bookEntries by key (for qsort)
+ */
+static int compareEntries(const void *a, const void *b)
+{
+    const struct bookEntry *x = a, *y = b;
+    return compareKeys(x->hits, x->misses, y->hits, y->misses);
+}
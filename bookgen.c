@@ -0,0 +1,161 @@
+#include "./headers/solver.h"
+#include "./headers/book.h"
+#include "./headers/threadpool.h"
+
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * Opening book generator: solves the first few positions of a game
+ * offline and writes them to a book file for the solver (see book.c).
+ * 
+ * Starting from the empty board, the move of each position is played and
+ * both answers to it (a miss and a hit) are solved in turn, down to the
+ * given # of guesses, so the book has every position the solver can reach
+ * in that many guesses without a ship sinking: 2^depth - 1 of them (fewer
+ * once symmetric positions are merged). Each position is solved
+ * with many more samples than a move can afford, or exactly.
+ * 
+ * Flags:
+ * -d <n> solve the positions of the first n guesses (default: 6)
+ * -n <n> sample n configs per position (default: 100M, 10x a move), and
+ *    draw n / 20 boards once there are hits
+ * -x count every position exactly instead (slow on an empty board)
+ * -t <n> use n threads per position (default: # of cores)
+ * -s <n> seed the random number generators with n (default: 1)
+ * -o <file> write the book to file (default: book.bin)
+ */
+
+// the book being built
+struct bookEntry *entries;
+long long numEntries;
+long long entryCapacity;
+
+// solves a position and the positions after its move, down to the given depth
+int solvePosition(struct solver *, int[BOARD_SIDELENGTH * BOARD_SIDELENGTH], int, int);
+
+int main(int argc, char *argv[])
+{
+    struct solverOptions options;
+    solverDefaultOptions(&options);
+    options.numThreads = defaultNumThreads();
+    options.randomSeed = 1;
+    options.maxConfigsTested = 100000000;
+    options.maxChainSamples = options.maxConfigsTested / 20;
+
+    int depth = 6;
+    const char *path = "book.bin";
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:n:xt:s:o:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'd':
+            depth = atoi(optarg);
+            if (depth < 1)
+                depth = 1;
+            break;
+        case 'n':
+            options.maxConfigsTested = atoi(optarg);
+            if (options.maxConfigsTested < 20)
+                options.maxConfigsTested = 20;
+            options.maxChainSamples = options.maxConfigsTested / 20;
+            break;
+        case 'x':
+            options.exactJoin = 1;
+            break;
+        case 't':
+            options.numThreads = atoi(optarg);
+            if (options.numThreads < 1)
+                options.numThreads = 1;
+            break;
+        case 's':
+            options.randomSeed = strtoul(optarg, NULL, 10);
+            break;
+        case 'o':
+            path = optarg;
+            break;
+        default:
+            printf("Usage: %s [-d depth] [-n configs] [-x] [-t threads] [-s seed] [-o book file]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    struct solver *solver = solverCreate(&options);
+    if (solver == NULL)
+        return 1;
+
+    int status[BOARD_SIDELENGTH * BOARD_SIDELENGTH];
+    for (int square = 0; square < BOARD_SIDELENGTH * BOARD_SIDELENGTH; square++)
+        status[square] = 1;
+
+    int failed = solvePosition(solver, status, 0, depth);
+    solverDestroy(solver);
+
+    if (!failed && bookWrite(path, entries, numEntries))
+    {
+        printf("Couldn't write %s\n", path);
+        failed = 1;
+    }
+    else if (!failed)
+        printf("Wrote %lld position(s) to %s\n", numEntries, path);
+    free(entries);
+
+    return failed;
+}
+
+/**
+ * Solves a position (with no ship sunk), adds it to the book, and solves
+ * the positions after a miss and a hit on its move
+ * 
+ * @param status status of each square (see solverLoadBoard), restored on return
+ * @param guesses # of guesses made in the position
+ * @param depth # of guesses the book goes up to
+ * @return 0 on success, 1 if the book couldn't be grown
+ */
+int solvePosition(struct solver *solver, int status[BOARD_SIDELENGTH * BOARD_SIDELENGTH], int guesses, int depth)
+{
+    int sunk[5] = {-1, -1, -1, -1, -1};
+    uint64_t hits[2] = {0, 0}, misses[2] = {0, 0};
+    for (int square = 0; square < BOARD_SIDELENGTH * BOARD_SIDELENGTH; square++)
+    {
+        if (status[square] == 3)
+            hits[square / 64] |= 1ULL << (square % 64);
+        else if (status[square] == 2)
+            misses[square / 64] |= 1ULL << (square % 64);
+    }
+
+    double startTime = wallTime();
+    int move = solverMove(solver, status, sunk);
+    // (no board fits, the position can't come up)
+    if (move < 0)
+        return 0;
+
+    printf("Guess %d: position %lld, move %d (%.2fs)\n", guesses + 1, numEntries, move, wallTime() - startTime);
+    fflush(stdout);
+
+    if (numEntries == entryCapacity)
+    {
+        long long capacity = entryCapacity > 0 ? entryCapacity * 2 : 64;
+        struct bookEntry *grown = realloc(entries, capacity * sizeof(struct bookEntry));
+        if (grown == NULL)
+            return 1;
+        entries = grown;
+        entryCapacity = capacity;
+    }
+    bookMakeEntry(entries + numEntries++, hits, misses, move);
+
+    if (guesses + 1 >= depth)
+        return 0;
+
+    int failed = 0;
+    for (int hit = 0; hit <= 1 && !failed; hit++)
+    {
+        status[move] = hit ? 3 : 2;
+        failed = solvePosition(solver, status, guesses + 1, depth);
+    }
+    status[move] = 1;
+
+    return failed;
+}
@@ -0,0 +1,208 @@
+/**
+ * Move cache: the moves (and square frequencies) generated for board
+ * states, so that a state that comes up again, in the same game or in
+ * another one, costs a lookup instead of a search.
+ * 
+ * A state is keyed by the solver's Zobrist hash of its board status and
+ * sunk ships (see solver.c). The cache holds up to a fixed # of states
+ * and evicts the least recently used one to make room: the states live
+ * in one array of nodes, linked in order of use, with a hashmap from
+ * key to node. One mutex guards it all, so any number of solvers (on
+ * any thread) can share one cache; a lookup or an insert is short next
+ * to the search it saves.
+ */
+
+#include "./headers/cache.h"
+#include "./headers/hashmap.h"
+
+#include <string.h>
+#include <pthread.h>
+
+// a state in the cache, linked to the ones used just before and after it
+struct cacheNode
+{
+    struct moveCacheEntry entry;
+    int newer; // -1 for none
+    int older; // -1 for none
+};
+
+struct moveCache
+{
+    pthread_mutex_t lock;
+    struct cacheNode *nodes; // capacity nodes, the first size of them in use
+    struct hashmap *index;   // key -> node
+    int newest;              // most recently used node, -1 if empty
+    int oldest;              // least recently used node, -1 if empty
+    struct moveCacheStats stats;
+};
+
+// takes a node out of the order of use
+static void unlinkNode(struct moveCache *, int);
+// puts a node first in the order of use
+static void pushNode(struct moveCache *, int);
+
+/**
+ * Creates an empty cache
+ * 
+ * @param capacity max # of states (at least 1)
+ * @return the cache, or NULL if it couldn't be allocated
+ */
+struct moveCache *moveCacheCreate(int capacity)
+{
+    if (capacity < 1)
+        capacity = 1;
+
+    struct moveCache *cache = malloc(sizeof(struct moveCache));
+    if (cache == NULL)
+        return NULL;
+
+    // (the index is made big enough for every state, so it never grows)
+    cache->nodes = malloc(capacity * sizeof(struct cacheNode));
+    cache->index = hashmapCreate(capacity);
+    if (cache->nodes == NULL || cache->index == NULL)
+    {
+        free(cache->nodes);
+        if (cache->index != NULL)
+            hashmapDestroy(cache->index);
+        free(cache);
+        return NULL;
+    }
+
+    pthread_mutex_init(&cache->lock, NULL);
+    cache->newest = cache->oldest = -1;
+    memset(&cache->stats, 0, sizeof(cache->stats));
+    cache->stats.capacity = capacity;
+
+    return cache;
+}
+
+/**
+ * Frees a cache (no solver may use it any more)
+ */
+void moveCacheDestroy(struct moveCache *cache)
+{
+    if (cache == NULL)
+        return;
+
+    pthread_mutex_destroy(&cache->lock);
+    hashmapDestroy(cache->index);
+    free(cache->nodes);
+    free(cache);
+}
+
+/**
+ * Looks a state up, making it the most recently used one if it's there
+ * 
+ * @param key the state's Zobrist hash
+ * @param entry filled in with the state's entry if it's in the cache
+ * @return 1 if it's in the cache, 0 otherwise
+ */
+int moveCacheGet(struct moveCache *cache, uint64_t key, struct moveCacheEntry *entry)
+{
+    pthread_mutex_lock(&cache->lock);
+
+    long long node;
+    int found = hashmapGet(cache->index, (long long)key, &node);
+    if (found)
+    {
+        unlinkNode(cache, node);
+        pushNode(cache, node);
+        *entry = cache->nodes[node].entry;
+        cache->stats.hits++;
+    }
+    else
+        cache->stats.misses++;
+
+    pthread_mutex_unlock(&cache->lock);
+
+    return found;
+}
+
+/**
+ * Adds a state (or replaces it if it's already there) as the most recently
+ * used one, evicting the least recently used state if the cache is full
+ * 
+ * @param entry the state's entry (copied)
+ * @return 0 on success, 1 if the index couldn't grow (the state is then
+ *         left out)
+ */
+int moveCachePut(struct moveCache *cache, const struct moveCacheEntry *entry)
+{
+    pthread_mutex_lock(&cache->lock);
+
+    long long node;
+    if (hashmapGet(cache->index, (long long)entry->key, &node))
+        unlinkNode(cache, node);
+    else if (cache->stats.size < cache->stats.capacity)
+    {
+        node = cache->stats.size;
+        if (hashmapPut(cache->index, (long long)entry->key, node))
+        {
+            pthread_mutex_unlock(&cache->lock);
+            return 1;
+        }
+        cache->stats.size++;
+    }
+    else
+    {
+        // (the put can't fail: it replaces the key just removed)
+        node = cache->oldest;
+        unlinkNode(cache, node);
+        hashmapRemove(cache->index, (long long)cache->nodes[node].entry.key);
+        hashmapPut(cache->index, (long long)entry->key, node);
+        cache->stats.evictions++;
+    }
+
+    cache->nodes[node].entry = *entry;
+    pushNode(cache, node);
+    cache->stats.insertions++;
+
+    pthread_mutex_unlock(&cache->lock);
+
+    return 0;
+}
+
+/**
+ * Fills in what a cache has done so far (its hit, miss and eviction
+ * counts, to size it by)
+ */
+void moveCacheGetStats(struct moveCache *cache, struct moveCacheStats *stats)
+{
+    pthread_mutex_lock(&cache->lock);
+    *stats = cache->stats;
+    pthread_mutex_unlock(&cache->lock);
+}
+
+/**
+ * Takes a node out of the order of use (linking its neighbours together)
+ */
+static void unlinkNode(struct moveCache *cache, int node)
+{
+    struct cacheNode *n = cache->nodes + node;
+
+    if (n->newer >= 0)
+        cache->nodes[n->newer].older = n->older;
+    else
+        cache->newest = n->older;
+
+    if (n->older >= 0)
+        cache->nodes[n->older].newer = n->newer;
+    else
+        cache->oldest = n->newer;
+}
+
+/**
+ * Puts a node (not in the order of use) first in it
+ */
+static void pushNode(struct moveCache *cache, int node)
+{
+    struct cacheNode *n = cache->nodes + node;
+
+    n->newer = -1;
+    n->older = cache->newest;
+    if (cache->newest >= 0)
+        cache->nodes[cache->newest].newer = node;
+    else
+        cache->oldest = node;
+    cache->newest = node;
+}
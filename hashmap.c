@@ -1,114 +1,312 @@
 /**
- * This was a simple integer-integer hashmap I wrote for
- * my ATCS Compilers and Interpreters class. It can only
- * handle putting in and retrieving numbers, and can not
- * remove or search for elements in the map. It also tries
- * to simulate some level of object-oriented-ness (kind of lol).
+ * An integer-integer hashmap (64-bit keys and values), originally
+ * written as a fixed-size chained table for my ATCS Compilers and
+ * Interpreters class and since rewritten for use in caches and memo
+ * tables.
  * 
- * For the purposes of the battleship project, the
- * NULL value placeholder has just been changed to -1
- * because it's easier and battleship never puts -1
- * in the map anyway.
+ * It uses open addressing with Robin Hood hashing: every key is stored
+ * in a single array of slots, as close as possible to the slot its hash
+ * points to, and an insert that has probed further than the key already
+ * in a slot takes that slot over. This keeps probe sequences short and
+ * even, so lookups (including misses) touch very few slots. Deleting
+ * shifts the following keys back, so no tombstones are left behind.
+ * 
+ * The map owns all of its memory: keys and values are copied in, and
+ * hashmapDestroy frees everything. The table doubles when it gets more
+ * than 80% full.
  */
 
 #include "./headers/hashmap.h"
 
-int size = 1024; // size of 1 level of hashmap
+#include <stdint.h>
 
-/**
- * Knuth hash function
- * @param a the integer number
- */ 
-int hash(int a) {         
-    return (a*2654435761) % size;
-}
+#define MIN_CAPACITY 16
+#define MAX_LOAD_NUMERATOR 4   // max load factor is 4/5
+#define MAX_LOAD_DENOMINATOR 5
+
+struct slot
+{
+    long long key;
+    long long val;
+    int distance; // 1 + # of slots from the slot the key hashes to, 0 if empty
+};
 
-// pseudo-linked list 
-struct entry
+struct hashmap
 {
-    int key;          // unhashed int key
-    int val;          // value
-    struct entry *next; // next in the list
+    struct slot *slots;
+    int capacity; // # of slots, a power of 2
+    int size;     // # of keys in the map
 };
 
 /**
- * Allocates space for the map and initializes -1 values
+ * Mixes all the bits of the key (splitmix64 finalizer), so that keys
+ * that only differ in their high bits still land in different slots
+ * @param a the integer key
+ */
+static uint64_t hash(long long a)
+{
+    uint64_t x = (uint64_t)a;
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/**
+ * Allocates the slots of an empty map
+ * 
+ * @return 0 on success, 1 if they couldn't be allocated (the map is
+ *         left as it was)
  */
-struct entry *initializeHashmap()
+static int allocateSlots(struct hashmap *map, int capacity)
 {
-    struct entry *map; // entry array
+    struct slot *slots = calloc(capacity, sizeof(struct slot));
+    if (slots == NULL)
+        return 1;
+
+    map->slots = slots;
+    map->capacity = capacity;
+    map->size = 0;
 
-    map = malloc(size * sizeof(struct entry));
+    return 0;
+}
 
-    for (int i = 0; i < size; i++)
+/**
+ * Allocates an empty map
+ * 
+ * @param capacity # of keys the map should hold before it has to grow
+ * @return the map, or NULL if it couldn't be allocated
+ */
+struct hashmap *hashmapCreate(int capacity)
+{
+    int slots = MIN_CAPACITY;
+    while ((long long)slots * MAX_LOAD_NUMERATOR < (long long)capacity * MAX_LOAD_DENOMINATOR)
+        slots *= 2;
+
+    struct hashmap *map = malloc(sizeof(struct hashmap));
+    if (map == NULL)
+        return NULL;
+    if (allocateSlots(map, slots))
     {
-        map[i].key = -1;;
-        map[i].next = NULL;
+        free(map);
+        return NULL;
     }
 
     return map;
 }
 
 /**
- * Adds an entry to the map.
- * Case 1: the address is unoccupied in the array
- * Case 2: the address is occupied and the key exists
- * Case 3: the address is occupied but the key does not exist
+ * Frees the map and everything in it
+ */
+void hashmapDestroy(struct hashmap *map)
+{
+    if (map == NULL)
+        return;
+
+    free(map->slots);
+    free(map);
+
+    return;
+}
+
+/**
+ * Inserts a key that is not in the map yet, without growing it
+ */
+static void insertSlot(struct hashmap *map, long long key, long long value)
+{
+    int mask = map->capacity - 1;
+    struct slot ent = {key, value, 1};
+    int address = hash(key) & mask;
+
+    while (1)
+    {
+        struct slot *current = map->slots + address;
+
+        // empty slot, the key goes here
+        if (current->distance == 0)
+        {
+            *current = ent;
+            map->size++;
+            return;
+        }
+
+        // the key in this slot is closer to home than this one, take its
+        // slot and keep looking for a slot for the displaced key
+        if (current->distance < ent.distance)
+        {
+            struct slot displaced = *current;
+            *current = ent;
+            ent = displaced;
+        }
+
+        address = (address + 1) & mask;
+        ent.distance++;
+    }
+}
+
+/**
+ * Doubles the # of slots and reinserts every key
  * 
- * @param ent pointer to the entry to add
+ * @return 0 on success, 1 if the new slots couldn't be allocated (the
+ *         map is left as it was)
  */
-void addEntry(struct entry *ent, struct entry *map)
+static int grow(struct hashmap *map)
 {
-    int address = hash(ent->key);
-    struct entry *current = map + address;
+    struct slot *oldSlots = map->slots;
+    int oldCapacity = map->capacity;
 
-    // empty list, add key-value pair directly
-    if (current->key == -1) map[address] = *ent;
-    else
+    if (allocateSlots(map, oldCapacity * 2))
+        return 1;
+
+    for (int i = 0; i < oldCapacity; i++)
     {
-        // get to the tail of the list or the first matching key
-        while (current->next != NULL && ent->key != current->key) current = current->next;
+        if (oldSlots[i].distance != 0)
+            insertSlot(map, oldSlots[i].key, oldSlots[i].val);
+    }
+
+    free(oldSlots);
+
+    return 0;
+}
 
-        // key exists, just replace the value
-        if (ent->key == current->key) current->val = ent->val;
-        else current->next = ent; // otherwise concat it to the list
+/**
+ * Returns the address of the slot holding key, or -1 if it's not in the map
+ */
+static int findSlot(struct hashmap *map, long long key)
+{
+    int mask = map->capacity - 1;
+    int address = hash(key) & mask;
+
+    // once the slots hold keys closer to home than this one would be,
+    // the key can't be further along
+    for (int distance = 1; map->slots[address].distance >= distance; distance++)
+    {
+        if (map->slots[address].key == key)
+            return address;
+        address = (address + 1) & mask;
     }
 
-    return;
+    return -1;
 }
 
-int get(int key, struct entry *map)
+/**
+ * Gets the value of a key
+ * 
+ * @param key the key
+ * @param value set to the key's value if it's in the map (may be NULL)
+ * @return 1 if the key is in the map, 0 otherwise
+ */
+int hashmapGet(struct hashmap *map, long long key, long long *value)
 {
-    int address = hash(key);
-    struct entry *current = map + address;
+    int address = findSlot(map, key);
+    if (address == -1)
+        return 0;
 
-    int comparison = key - current->key;
+    if (value != NULL)
+        *value = map->slots[address].val;
+    return 1;
+}
 
-    while (current->next != NULL && comparison != 0)
+/**
+ * Puts a new value into the map, replacing the key's old value if
+ * it is already in the map
+ * 
+ * @param key the key
+ * @param value the value
+ * @return 0 on success, 1 if the map had to grow and couldn't (the key
+ *         is then not added)
+ */
+int hashmapPut(struct hashmap *map, long long key, long long value)
+{
+    int address = findSlot(map, key);
+    if (address != -1)
     {
-        current = current->next;
-        comparison = key - current->key;
+        map->slots[address].val = value;
+        return 0;
     }
 
-    return comparison == 0 ? current->val : -1;
+    if ((long long)(map->size + 1) * MAX_LOAD_DENOMINATOR > (long long)map->capacity * MAX_LOAD_NUMERATOR &&
+        grow(map))
+        return 1;
+
+    insertSlot(map, key, value);
+
+    return 0;
 }
 
 /**
- * Puts a new value into the map
+ * Removes a key from the map
  * 
  * @param key the key
- * @param value the value
- * @param map the map
+ * @return 1 if the key was in the map, 0 otherwise
  */
-void put(int key, int value, struct entry *map)
+int hashmapRemove(struct hashmap *map, long long key)
 {
-    struct entry e;
+    int address = findSlot(map, key);
+    if (address == -1)
+        return 0;
+
+    // shift the keys after it back by one slot until one is already home
+    int mask = map->capacity - 1;
+    int next = (address + 1) & mask;
+    while (map->slots[next].distance > 1)
+    {
+        map->slots[address] = map->slots[next];
+        map->slots[address].distance--;
+        address = next;
+        next = (next + 1) & mask;
+    }
+    map->slots[address].distance = 0;
+    map->size--;
 
-    e.key = key;
-    e.val = value;
-    e.next = NULL;
+    return 1;
+}
 
-    addEntry(&e, map);
+/**
+ * Returns the # of keys in the map
+ */
+int hashmapSize(struct hashmap *map)
+{
+    return map->size;
+}
+
+/**
+ * Removes every key from the map (keeping its capacity)
+ */
+void hashmapClear(struct hashmap *map)
+{
+    memset(map->slots, 0, map->capacity * sizeof(struct slot));
+    map->size = 0;
 
     return;
-}
\ No newline at end of file
+}
+
+/**
+ * Iterates over the map. Start with *position = 0 and call until it
+ * returns 0; every key is visited once, in no particular order. The
+ * map must not be changed while iterating.
+ * 
+ * @param position the iteration position, updated
+ * @param key set to the next key (may be NULL)
+ * @param value set to the next key's value (may be NULL)
+ * @return 1 if there was a next key, 0 once all keys have been visited
+ */
+int hashmapNext(struct hashmap *map, int *position, long long *key, long long *value)
+{
+    while (*position < map->capacity)
+    {
+        struct slot *current = map->slots + (*position)++;
+        if (current->distance != 0)
+        {
+            if (key != NULL)
+                *key = current->key;
+            if (value != NULL)
+                *value = current->val;
+            return 1;
+        }
+    }
+
+    return 0;
+}
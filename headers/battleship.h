@@ -2,7 +2,17 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <math.h>
 #include <time.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
 
-#include "./hashmap.h"
\ No newline at end of file
+#include "./solver.h"
+#include "./server.h"
+#include "./threadpool.h"
+#include "./mt.h"
+#include "./trace.h"
+#include "./book.h"
+#include "./cache.h"
+
+#define DEBUG 1 // set to 1 to print debug messages, 0 otherwise
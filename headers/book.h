@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+// opening book: the moves of early positions, solved offline by bookgen
+// and memory-mapped by the clients of libbattleship (see book.c)
+
+// one position and its move, as stored in a book file: the hit and missed
+// squares as 100-bit masks (bit y * 10 + x, low word first), with the
+// move in the top 8 bits of hits[1]
+struct bookEntry
+{
+    uint64_t hits[2];
+    uint64_t misses[2];
+};
+
+struct openingBook;
+
+struct openingBook *bookOpen(const char *path);
+
+void bookClose(struct openingBook *book);
+
+long long bookSize(const struct openingBook *book);
+
+int bookLookup(const struct openingBook *book, const uint64_t hits[2], const uint64_t misses[2]);
+
+void bookMakeEntry(struct bookEntry *entry, const uint64_t hits[2], const uint64_t misses[2], int move);
+
+int bookWrite(const char *path, struct bookEntry *entries, long long numEntries);
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "./solver.h"
+
+// move cache: the moves generated for board states, keyed by the solver's
+// Zobrist hash of the state and shared by any number of solvers (see cache.c)
+
+// one board state and what generating its move found
+struct moveCacheEntry
+{
+    uint64_t key;            // Zobrist hash of the state
+    int move;                // the square guessed, -1 if no board fits
+    long long validConfigs;  // # of valid boards found (counted or sampled)
+    long long frequencies[BOARD_SIDELENGTH * BOARD_SIDELENGTH]; // # of them covering each square
+};
+
+// what a cache has done since it was created
+struct moveCacheStats
+{
+    long long hits;
+    long long misses;
+    long long insertions;
+    long long evictions;
+    int size;     // # of states in the cache
+    int capacity; // max # of states
+};
+
+struct moveCache;
+
+struct moveCache *moveCacheCreate(int capacity);
+
+void moveCacheDestroy(struct moveCache *cache);
+
+int moveCacheGet(struct moveCache *cache, uint64_t key, struct moveCacheEntry *entry);
+
+int moveCachePut(struct moveCache *cache, const struct moveCacheEntry *entry);
+
+void moveCacheGetStats(struct moveCache *cache, struct moveCacheStats *stats);
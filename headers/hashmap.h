@@ -4,16 +4,20 @@
 #include <stdlib.h>
 #include <string.h>
 
-struct entry;
+struct hashmap;
 
-struct entry* initializeHashmap();
+struct hashmap *hashmapCreate(int capacity);
 
-void addEntry(struct entry *ent, struct entry *map);
+void hashmapDestroy(struct hashmap *map);
 
-int get(int key, struct entry *map);
+int hashmapGet(struct hashmap *map, long long key, long long *value);
 
-void put(int key, int value, struct entry *map);
+int hashmapPut(struct hashmap *map, long long key, long long value);
 
-void printKeys(struct entry *map);
+int hashmapRemove(struct hashmap *map, long long key);
 
-int getSize();
\ No newline at end of file
+int hashmapSize(struct hashmap *map);
+
+void hashmapClear(struct hashmap *map);
+
+int hashmapNext(struct hashmap *map, int *position, long long *key, long long *value);
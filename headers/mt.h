@@ -0,0 +1,24 @@
+#pragma once
+
+#define MT_STATE_SIZE 624 // N in mt.c
+
+// state of one Mersenne Twister stream, for use from several threads
+struct mtState
+{
+    unsigned long mt[MT_STATE_SIZE]; // the array for the state vector
+    int mti;                         // mti == MT_STATE_SIZE + 1 means mt is not initialized
+};
+
+void init_genrand(unsigned long s);
+
+void init_by_array(unsigned long init_key[], int key_length);
+
+unsigned long genrand_int32(void);
+
+void init_genrand_r(struct mtState *state, unsigned long s);
+
+void init_by_array_r(struct mtState *state, unsigned long init_key[], int key_length);
+
+unsigned long genrand_int32_r(struct mtState *state);
+
+double genrand_res53_r(struct mtState *state);
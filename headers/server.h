@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "./solver.h"
+#include "./hashmap.h"
+#include "./threadpool.h"
+#include "./cache.h"
+
+// server mode: many games at once over a line protocol on stdin/stdout
+// (see server.c for the commands)
+int serve(const struct solverOptions *options, int numWorkers, int queueCapacity);
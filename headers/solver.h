@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+// libbattleship: the move generator, one struct solver per game
+// (see solver.c). Squares are numbered y * 10 + x from the bottom left,
+// ship s has length 2, 3, 3, 4, 5 for s = 0 to 4, and a ship's config id
+// is y * 100 + x * 10 + o for its bottom or left square <x, y>, with o = 0
+// for up and 1 for right. Different solvers can be used from different
+// threads at the same time; one solver by one thread at a time.
+
+#define BOARD_SIDELENGTH 10 // side length of square battleship board. MAX 10
+
+struct solver;
+struct openingBook;
+struct moveCache;
+
+struct solverOptions
+{
+    int numThreads;              // # of threads used to generate a move
+    unsigned long randomSeed;    // seed for the random number generators
+    int moveTimeBudgetMs;        // wall-clock budget for each move in ms, 0 for none
+    int exactJoin;               // 1 to count states too large to enumerate exactly instead of sampling them
+    int maxConfigsTested;        // # of configs sampled per move (without hits)
+    int maxChainSamples;         // # of boards drawn per move by the hit-constrained sampler
+    double maxConfigsEnumerated; // max # of configs (product of the ship config counts) still enumerated exactly
+    int reuseSamples;            // 1 to keep the sampled boards from one move to the next, 0 to sample every move afresh
+    int maxFleetsKept;           // max # of enumerated boards kept and filtered by the next moves, 0 to enumerate every move afresh
+    const struct openingBook *book; // moves played without a search in the positions it has, NULL for none (see book.c)
+    struct moveCache *cache;     // moves of the states seen before, shared by solvers with the same options, NULL for none (see cache.c)
+    FILE *log;                   // where progress and debug messages go, NULL for nowhere
+};
+
+void solverDefaultOptions(struct solverOptions *options);
+
+struct solver *solverCreate(const struct solverOptions *options);
+
+void solverDestroy(struct solver *solver);
+
+void solverNewGame(struct solver *solver);
+
+int solverLoadBoard(struct solver *solver, const int status[BOARD_SIDELENGTH * BOARD_SIDELENGTH], const int sunk[5]);
+
+int solverNextMove(struct solver *solver);
+
+int solverMove(struct solver *solver, const int status[BOARD_SIDELENGTH * BOARD_SIDELENGTH], const int sunk[5]);
+
+int solverRecordGuess(struct solver *solver, int square, int hit);
+
+int solverSpeculate(struct solver *solver, int square);
+
+int solverRecordSinkage(struct solver *solver, int s, int config);
+
+int solverSquare(const struct solver *solver, int square);
+
+int solverShipSunk(const struct solver *solver, int s);
+
+int solverNumGuesses(const struct solver *solver);
+
+int solverGameOver(const struct solver *solver);
+
+long long solverConfigsEvaluated(const struct solver *solver);
+
+long long solverSquareFrequency(const struct solver *solver, int square);
+
+int solverExportTrace(struct solver *solver, const char *path);
+
+int solverNumShipConfigs(int s);
+
+int solverShipConfig(int s, int c);
+
+// returns a ship's length given its index
+// in order: 0,1,2,3,4 --> 2,3,3,4,5
+int shipLengthFromIndex(int i);
+
+double wallTime(void);
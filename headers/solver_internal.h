@@ -0,0 +1,34 @@
+#pragma once
+
+#include "./solver.h"
+
+// internals of libbattleship that the stage benchmark (bench/stagebench.c)
+// calls directly, to time each stage of generating a move on its own;
+// not part of the API (see solver.h), and only valid while no move is
+// being generated
+
+// Generates all configurations for each ship on an empty board
+void generateShipConfigs(void);
+// Determines for all pairs of ship configs if the ships will collide
+void determineShipCollisions(void);
+// Rules out the ship configs that can't be part of a valid board, returns the # removed
+int propagateShipConfigs(struct solver *solver);
+// returns the # of boards in the product of the valid config lists
+double numConfigsToBeTested(struct solver *solver);
+// tests if the given ship configuration is possible (given current board status)
+// takes an index into shipConfigs for each ship
+int validConfig(struct solver *solver, int testedShipConfigs[5]);
+// randomly tests maxConfigsTested configs (or fewer, reusing the boards of the last move)
+long long randomlyTestConfigs(struct solver *solver);
+// brute force tests all possible configs
+long long bruteForceTestConfigs(struct solver *solver);
+// calculates and returns the best move after all ship frequencies have been determined
+int calculateBestMove(struct solver *solver, long long totalTested);
+
+// counts a guess without generating its move, as solverNextMove does
+// before generating one (the move's random streams depend on the count)
+void countGuess(struct solver *solver);
+// returns the # of configs of ship s still valid
+int numValidConfigs(const struct solver *solver, int s);
+// returns the i-th config still valid of ship s (an index into its configs)
+int validShipConfig(const struct solver *solver, int s, int i);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+// a task: called with the task index, the index of the thread running it
+// (0 to numThreads - 1) and the shared argument
+typedef void (*taskFunction)(int, int, void *);
+
+int defaultNumThreads(void);
+
+void runParallel(int numThreads, int numTasks, taskFunction task, void *arg);
+
+// a queued task: called with the index of the thread running it and its argument
+typedef void (*queuedFunction)(int, void *);
+
+struct taskQueue;
+
+struct taskQueue *taskQueueCreate(int numThreads, int capacity);
+
+int taskQueueSubmit(struct taskQueue *queue, queuedFunction task, void *arg);
+
+int taskQueueDepth(struct taskQueue *queue);
+
+void taskQueueDestroy(struct taskQueue *queue);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// set to 1 (make TRACE=1) to record spans and counters of the move
+// generator; with 0 every TRACE_ macro compiles to nothing. Each solver
+// records into its own buffer, which its client exports after each move
+// (see solverExportTrace)
+#ifndef TRACE
+#define TRACE 0
+#endif
+
+// what the move generator did with the boards (or configs) it looked at
+struct traceCounters
+{
+    long long candidates;    // boards/configs tried
+    long long collisions;    // rejected because two ships overlap
+    long long uncoveredHits; // rejected because a hit can't be covered
+    long long accepted;      // valid boards counted
+};
+
+struct traceBuffer;
+
+#if TRACE
+// starts a span: declares a variable holding its start time
+#define TRACE_SPAN_BEGIN(start) double start = traceNow()
+// ends a span started with TRACE_SPAN_BEGIN, recording it under name in a buffer
+#define TRACE_SPAN_END(buffer, start, name, thread) traceSpan(buffer, name, thread, start)
+// adds n to a counter (n isn't evaluated without TRACE)
+#define TRACE_COUNT(counter, n) ((counter) += (n))
+// records a snapshot of a set of counters in a buffer
+#define TRACE_COUNTERS(buffer, name, counters) traceSnapshot(buffer, name, counters)
+#else
+#define TRACE_SPAN_BEGIN(start) ((void)0)
+#define TRACE_SPAN_END(buffer, start, name, thread) ((void)0)
+#define TRACE_COUNT(counter, n) ((void)0)
+#define TRACE_COUNTERS(buffer, name, counters) ((void)0)
+#endif
+
+struct traceBuffer *traceBufferCreate(void);
+
+void traceBufferDestroy(struct traceBuffer *buffer);
+
+double traceNow(void);
+
+void traceSpan(struct traceBuffer *buffer, const char *name, int thread, double start);
+
+void traceSnapshot(struct traceBuffer *buffer, const char *name, struct traceCounters *counters);
+
+int traceExport(struct traceBuffer *buffer, const char *path);
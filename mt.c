@@ -41,8 +41,16 @@
    email: m-mat @ math.sci.hiroshima-u.ac.jp (remove space)
 */
 
+/*
+   Battleship note: the generator state is kept in a struct mtState so
+   that every thread can own a stream (the *_r functions). The original
+   functions work on one global stream, as before.
+*/
+
 #include <stdio.h>
 
+#include "./headers/mt.h"
+
 /* Period parameters */  
 #define N 624
 #define M 397
@@ -50,15 +58,14 @@
 #define UPPER_MASK 0x80000000UL /* most significant w-r bits */
 #define LOWER_MASK 0x7fffffffUL /* least significant r bits */
 
-static unsigned long mt[N]; /* the array for the state vector  */
-static int mti=N+1; /* mti==N+1 means mt[N] is not initialized */
-
-void init_generand(unsigned long s);
-unsigned long genrand_int32(void);
+static struct mtState global_state = { {0}, N+1 }; /* used by the non _r functions */
 
 /* initializes mt[N] with a seed */
-void init_genrand(unsigned long s)
+void init_genrand_r(struct mtState *state, unsigned long s)
 {
+    unsigned long *mt = state->mt;
+    int mti;
+
     mt[0]= s & 0xffffffffUL;
     for (mti=1; mti<N; mti++) {
         mt[mti] = 
@@ -70,16 +77,23 @@ void init_genrand(unsigned long s)
         mt[mti] &= 0xffffffffUL;
         /* for >32 bit machines */
     }
+    state->mti = mti;
+}
+
+void init_genrand(unsigned long s)
+{
+    init_genrand_r(&global_state, s);
 }
 
 /* initialize by an array with array-length */
 /* init_key is the array for initializing keys */
 /* key_length is its length */
 /* slight change for C++, 2004/2/26 */
-void init_by_array(unsigned long init_key[], int key_length)
+void init_by_array_r(struct mtState *state, unsigned long init_key[], int key_length)
 {
+    unsigned long *mt = state->mt;
     int i, j, k;
-    init_genrand(19650218UL);
+    init_genrand_r(state, 19650218UL);
     i=1; j=0;
     k = (N>key_length ? N : key_length);
     for (; k; k--) {
@@ -101,18 +115,24 @@ void init_by_array(unsigned long init_key[], int key_length)
     mt[0] = 0x80000000UL; /* MSB is 1; assuring non-zero initial array */ 
 }
 
+void init_by_array(unsigned long init_key[], int key_length)
+{
+    init_by_array_r(&global_state, init_key, key_length);
+}
+
 /* generates a random number on [0,0xffffffff]-interval */
-unsigned long genrand_int32(void)
+unsigned long genrand_int32_r(struct mtState *state)
 {
+    unsigned long *mt = state->mt;
     unsigned long y;
     static unsigned long mag01[2]={0x0UL, MATRIX_A};
     /* mag01[x] = x * MATRIX_A  for x=0,1 */
 
-    if (mti >= N) { /* generate N words at one time */
+    if (state->mti >= N) { /* generate N words at one time */
         int kk;
 
-        if (mti == N+1)   /* if init_genrand() has not been called, */
-            init_genrand(5489UL); /* a default initial seed is used */
+        if (state->mti == N+1)   /* if init_genrand() has not been called, */
+            init_genrand_r(state, 5489UL); /* a default initial seed is used */
 
         for (kk=0;kk<N-M;kk++) {
             y = (mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK);
@@ -125,10 +145,10 @@ unsigned long genrand_int32(void)
         y = (mt[N-1]&UPPER_MASK)|(mt[0]&LOWER_MASK);
         mt[N-1] = mt[M-1] ^ (y >> 1) ^ mag01[y & 0x1UL];
 
-        mti = 0;
+        state->mti = 0;
     }
   
-    y = mt[mti++];
+    y = mt[state->mti++];
 
     /* Tempering */
     y ^= (y >> 11);
@@ -139,6 +159,11 @@ unsigned long genrand_int32(void)
     return y;
 }
 
+unsigned long genrand_int32(void)
+{
+    return genrand_int32_r(&global_state);
+}
+
 /* generates a random number on [0,0x7fffffff]-interval */
 long genrand_int31(void)
 {
@@ -172,6 +197,12 @@ double genrand_res53(void)
     unsigned long a=genrand_int32()>>5, b=genrand_int32()>>6; 
     return(a*67108864.0+b)*(1.0/9007199254740992.0); 
 } 
+
+double genrand_res53_r(struct mtState *state) 
+{ 
+    unsigned long a=genrand_int32_r(state)>>5, b=genrand_int32_r(state)>>6; 
+    return(a*67108864.0+b)*(1.0/9007199254740992.0); 
+} 
 /* These real versions are due to Isaku Wada, 2002/01/09 added */
 
 // int main(void)
@@ -0,0 +1,352 @@
+/**
+ * Server mode: plays many games at once for other programs, over a line
+ * protocol on stdin/stdout (one command per line, one reply per line).
+ *
+ * Every game is a session with its own solver, named by a number picked
+ * by the client. Moves are generated by a fixed set of worker threads
+ * taking them from a bounded queue, so the reader never waits on a move;
+ * when the queue is full, it stops reading until there is room.
+ *
+ * Commands (coordinates are from 1, like the interactive game):
+ *   new <id>                    start a game          -> ok new <id>
+ *   move <id>                   queue the next guess  -> move <id> <x> <y> <latency ms> <wait ms> <depth>
+ *   hit <id> <x> <y>            answer a guess        -> ok hit <id>
+ *   miss <id> <x> <y>                                 -> ok miss <id>
+ *   sink <id> <ship> <x> <y> <o>  ship 1-5 sank       -> ok sink <id>
+ *   stats <id>                  latency and queue depth so far
+ *                               -> stats <id> moves <n> latency_ms <mean> <max> wait_ms <mean> depth <mean>
+ *   end <id>                    print the stats and end the game
+ *   cache                       move cache counters so far (with -c)
+ *                               -> cache hits <n> misses <n> evictions <n> size <n> <capacity>
+ *   quit                        (or end of input) finish the queued moves,
+ *                               print the stats of every game (and the
+ *                               cache's) and exit
+ *
+ * A move is answered once it is generated, so replies of different
+ * sessions can come out of order; latency is from the move being queued
+ * to it being answered, wait is the part of it spent in the queue and
+ * depth is the # of moves that were queued ahead of it. A session only
+ * takes one command at a time while its move is being generated (others
+ * get "err <id> busy"), and "move <id> none" means no board fits the
+ * answers given. Errors are "err <id> <reason>".
+ */
+
+#include "./headers/server.h"
+
+#define MAX_LINE 256 // max length of a command
+
+// one game played through the server
+struct session
+{
+    long long id;
+    struct server *server;
+    struct solver *solver;
+
+    pthread_mutex_t lock;   // guards everything below (the solver while a move is pending)
+    int pending;            // 1 while a move is queued or being generated
+    double queuedAt;        // wallTime() when the pending move was queued
+    int depth;              // # of moves queued ahead of the pending move
+
+    int numMoves;           // # of moves answered
+    double totalLatency;    // ms, from queued to answered
+    double maxLatency;
+    double totalWait;       // ms spent in the queue
+    long long totalDepth;
+};
+
+struct server
+{
+    struct solverOptions options; // options of every session's solver
+    struct taskQueue *queue;
+    struct hashmap *sessions;     // session id -> struct session * (only used by the reader)
+    pthread_mutex_t outputLock;   // keeps reply lines whole
+};
+
+/**
+ * Writes one reply line (printf-style)
+ */
+static void reply(struct server *server, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+
+    pthread_mutex_lock(&server->outputLock);
+    vprintf(format, args);
+    fflush(stdout);
+    pthread_mutex_unlock(&server->outputLock);
+
+    va_end(args);
+}
+
+/**
+ * Returns the session with the given id, or NULL if there is none
+ */
+static struct session *findSession(struct server *server, long long id)
+{
+    long long value;
+    if (!hashmapGet(server->sessions, id, &value))
+        return NULL;
+    return (struct session *)(intptr_t)value;
+}
+
+/**
+ * Prints the stats of a session (which must not have a move pending)
+ */
+static void replyStats(struct session *session)
+{
+    int n = session->numMoves;
+    reply(session->server, "stats %lld moves %d latency_ms %.3f %.3f wait_ms %.3f depth %.2f\n",
+          session->id, n,
+          n > 0 ? session->totalLatency / n : 0, session->maxLatency,
+          n > 0 ? session->totalWait / n : 0,
+          n > 0 ? (double)session->totalDepth / n : 0);
+}
+
+/**
+ * Prints the move cache's counters (shared by every session)
+ */
+static void replyCacheStats(struct server *server)
+{
+    if (server->options.cache == NULL)
+    {
+        reply(server, "err - no cache\n");
+        return;
+    }
+
+    struct moveCacheStats stats;
+    moveCacheGetStats(server->options.cache, &stats);
+    reply(server, "cache hits %lld misses %lld evictions %lld size %d %d\n",
+          stats.hits, stats.misses, stats.evictions, stats.size, stats.capacity);
+}
+
+/**
+ * Generates the pending move of a session and answers it (queued task)
+ *
+ * @param thread index of the worker thread
+ * @param arg the session
+ */
+void moveTask(int thread, void *arg)
+{
+    struct session *session = arg;
+
+    double startTime = wallTime();
+    int move = solverNextMove(session->solver);
+    double endTime = wallTime();
+
+#if TRACE
+    char tracePath[64];
+    snprintf(tracePath, sizeof(tracePath), "trace-session-%lld-move-%03d.json", session->id, solverNumGuesses(session->solver));
+    solverExportTrace(session->solver, tracePath);
+#endif
+
+    // (the session stays locked until the reply is out, so that the
+    // client's next command never finds the move still pending)
+    pthread_mutex_lock(&session->lock);
+
+    double latency = (endTime - session->queuedAt) * 1000;
+    double wait = (startTime - session->queuedAt) * 1000;
+    session->numMoves++;
+    session->totalLatency += latency;
+    session->totalWait += wait;
+    session->totalDepth += session->depth;
+    if (latency > session->maxLatency)
+        session->maxLatency = latency;
+
+    if (move < 0)
+        reply(session->server, "move %lld none %.3f %.3f %d\n", session->id, latency, wait, session->depth);
+    else
+        reply(session->server, "move %lld %d %d %.3f %.3f %d\n", session->id,
+              move % 10 + 1, move / 10 + 1, latency, wait, session->depth);
+
+    session->pending = 0;
+    pthread_mutex_unlock(&session->lock);
+
+    return;
+}
+
+/**
+ * Runs one command line
+ *
+ * @return 1 if the server should stop, 0 otherwise
+ */
+static int runCommand(struct server *server, const char *line)
+{
+    char command[16];
+    long long id;
+    int consumed = 0;
+
+    int numRead = sscanf(line, " %15s %lld%n", command, &id, &consumed);
+    if (numRead < 1)
+        return 0; // blank line
+    if (strcmp(command, "quit") == 0)
+        return 1;
+    if (strcmp(command, "cache") == 0)
+    {
+        replyCacheStats(server);
+        return 0;
+    }
+    if (numRead < 2)
+    {
+        reply(server, "err - expected a session id\n");
+        return 0;
+    }
+    const char *args = line + consumed;
+
+    if (strcmp(command, "new") == 0)
+    {
+        if (findSession(server, id) != NULL)
+        {
+            reply(server, "err %lld exists\n", id);
+            return 0;
+        }
+
+        struct session *session = calloc(1, sizeof(struct session));
+        if (session != NULL)
+            session->solver = solverCreate(&server->options);
+        if (session == NULL || session->solver == NULL)
+        {
+            free(session);
+            reply(server, "err %lld out of memory\n", id);
+            return 0;
+        }
+        session->id = id;
+        session->server = server;
+        pthread_mutex_init(&session->lock, NULL);
+        if (hashmapPut(server->sessions, id, (long long)(intptr_t)session))
+        {
+            pthread_mutex_destroy(&session->lock);
+            solverDestroy(session->solver);
+            free(session);
+            reply(server, "err %lld out of memory\n", id);
+            return 0;
+        }
+
+        reply(server, "ok new %lld\n", id);
+        return 0;
+    }
+
+    struct session *session = findSession(server, id);
+    if (session == NULL)
+    {
+        reply(server, "err %lld no such session\n", id);
+        return 0;
+    }
+
+    pthread_mutex_lock(&session->lock);
+    if (session->pending)
+    {
+        pthread_mutex_unlock(&session->lock);
+        reply(server, "err %lld busy\n", id);
+        return 0;
+    }
+
+    if (strcmp(command, "move") == 0)
+    {
+        session->pending = 1;
+        session->queuedAt = wallTime();
+        session->depth = taskQueueDepth(server->queue);
+        pthread_mutex_unlock(&session->lock);
+
+        // (waits here while the queue is full)
+        taskQueueSubmit(server->queue, moveTask, session);
+        return 0;
+    }
+
+    int x, y, ship, o;
+    if (strcmp(command, "hit") == 0 || strcmp(command, "miss") == 0)
+    {
+        if (sscanf(args, "%d %d", &x, &y) != 2 || x < 1 || x > BOARD_SIDELENGTH || y < 1 || y > BOARD_SIDELENGTH ||
+            solverRecordGuess(session->solver, (y - 1) * 10 + x - 1, command[0] == 'h'))
+            reply(server, "err %lld bad square\n", id);
+        else
+            reply(server, "ok %s %lld\n", command, id);
+    }
+    else if (strcmp(command, "sink") == 0)
+    {
+        if (sscanf(args, "%d %d %d %d", &ship, &x, &y, &o) != 4 || ship < 1 || ship > 5 ||
+            x < 1 || x > BOARD_SIDELENGTH || y < 1 || y > BOARD_SIDELENGTH || (o != 0 && o != 1) ||
+            solverRecordSinkage(session->solver, ship - 1, (y - 1) * 100 + (x - 1) * 10 + o))
+            reply(server, "err %lld bad ship\n", id);
+        else
+            reply(server, "ok sink %lld\n", id);
+    }
+    else if (strcmp(command, "stats") == 0)
+    {
+        replyStats(session);
+    }
+    else if (strcmp(command, "end") == 0)
+    {
+        replyStats(session);
+        hashmapRemove(server->sessions, id);
+        pthread_mutex_unlock(&session->lock);
+
+        pthread_mutex_destroy(&session->lock);
+        solverDestroy(session->solver);
+        free(session);
+        return 0;
+    }
+    else
+        reply(server, "err %lld unknown command\n", id);
+
+    pthread_mutex_unlock(&session->lock);
+
+    return 0;
+}
+
+/**
+ * Runs the server until quit or the end of input
+ *
+ * @param options options of each session's solver (numThreads is used
+ *                per move, so 1 is usually best)
+ * @param numWorkers # of worker threads generating moves
+ * @param queueCapacity max # of moves waiting for a worker
+ * @return 0, or 1 if the queue or the sessions couldn't be set up
+ */
+int serve(const struct solverOptions *options, int numWorkers, int queueCapacity)
+{
+    struct server server;
+    server.options = *options;
+    server.queue = taskQueueCreate(numWorkers, queueCapacity);
+    server.sessions = hashmapCreate(0);
+    if (server.queue == NULL || server.sessions == NULL)
+    {
+        printf("Couldn't start the server (out of memory or threads)\n");
+        if (server.queue != NULL)
+            taskQueueDestroy(server.queue);
+        if (server.sessions != NULL)
+            hashmapDestroy(server.sessions);
+        return 1;
+    }
+    pthread_mutex_init(&server.outputLock, NULL);
+
+    reply(&server, "ready %d worker(s) queue %d\n", numWorkers, queueCapacity);
+
+    char line[MAX_LINE];
+    while (fgets(line, sizeof(line), stdin) != NULL)
+    {
+        if (runCommand(&server, line))
+            break;
+    }
+
+    // finish the queued moves, then report on every session left
+    taskQueueDestroy(server.queue);
+
+    int position = 0;
+    long long id, value;
+    while (hashmapNext(server.sessions, &position, &id, &value))
+    {
+        struct session *session = (struct session *)(intptr_t)value;
+        replyStats(session);
+        pthread_mutex_destroy(&session->lock);
+        solverDestroy(session->solver);
+        free(session);
+    }
+
+    if (server.options.cache != NULL)
+        replyCacheStats(&server);
+
+    hashmapDestroy(server.sessions);
+    pthread_mutex_destroy(&server.outputLock);
+
+    return 0;
+}
@@ -0,0 +1,3396 @@
+/**
+ * libbattleship: the move generator, as a library that can run many
+ * games at once
+ * 
+ * All the state of one game (the board, the ship configs still valid,
+ * the frequencies of the last move and the settings) lives in a
+ * struct solver, and every function takes the solver it works on, so
+ * solvers can be used from different threads at the same time (each
+ * solver by one thread at a time). The only shared state is the table
+ * of ship configs and their collisions on an empty board, which is the
+ * same for every game: it's built once, by the first solverCreate, and
+ * only read from then on.
+ * 
+ * See headers/solver.h for the API; battleship.c is a client of it.
+ */
+
+#include "./headers/solver.h"
+#include "./headers/solver_internal.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "./headers/threadpool.h"
+#include "./headers/mt.h"
+#include "./headers/trace.h"
+#include "./headers/book.h"
+#include "./headers/cache.h"
+
+/* ----- MACROS ----- */
+
+#define BOARD_PADDING 4     // amount to pad on each side. should be equal to
+// the longest ship's length - 1
+#define DEBUG 1 // set to 1 to log debug messages, 0 otherwise
+
+#define MAX_SHIP_CONFIGS 200 // max # of configs a single ship can have
+#define CONFIG_WORDS ((MAX_SHIP_CONFIGS + 63) / 64) // 64-bit words per config bitset
+#define SAMPLE_CHUNK 16384  // # of configs sampled between deadline checks
+#define CHAIN_CHUNK 1024    // # of chain steps between deadline checks
+#define CHAIN_BURN_IN 1000  // # of chain steps discarded before sampling
+#define JOIN_CHUNK 64       // # of placements joined per threadpool task
+#define FLEETS_PER_NODE 1   // max # of boards kept per search node, past KEPT_FLEETS_SLACK
+#define KEPT_FLEETS_SLACK 4096 // # of boards always kept; past that, filtering costs more than searching again
+#define ZOBRIST_SEED 5489UL // seed of the Zobrist keys (fixed, so every solver hashes a state the same way)
+
+// 128-bit occupancy mask over the 100 board squares
+// bit (y * 10 + x) is set if square <x, y> is occupied
+typedef unsigned __int128 bitboard;
+
+/* ----- SHARED TABLES ----- */
+
+// built once by buildShipTables and never changed afterwards, so every
+// solver (on any thread) reads them without locking
+
+// stores the ship orientations on an empty board (sort of like a list);
+// a config index always refers to the same orientation. As guesses come
+// in, configs are ruled out in each solver's shipConfigBits and
+// validShipConfigs rather than removed from here.
+// stores numbers formatted as such: spot index * 10 + orientation
+// spot index is a number from 0 to 99
+// orientation is 0 or 1, depending on up or right orientation
+static int shipConfigs[5][MAX_SHIP_CONFIGS];
+// stores the occupancy mask of each config in shipConfigs
+static bitboard shipConfigMasks[5][MAX_SHIP_CONFIGS];
+// stores the squares (y * 10 + x) covered by each config in shipConfigs,
+// from its bottom or left square on (the first shipLengths[s] are used)
+static unsigned char shipConfigSquares[5][MAX_SHIP_CONFIGS][5];
+// length of each ship (ship order: 2,3,3,4,5)
+static const int shipLengths[5] = {2, 3, 3, 4, 5};
+// stores the # of ship orientations in shipConfigs for each ship
+static int numShipConfigs[5];
+// bit c of shipSquareConfigs[s][i] is set if config c of ship s covers square i
+static uint64_t shipSquareConfigs[5][BOARD_SIDELENGTH * BOARD_SIDELENGTH][CONFIG_WORDS];
+
+// dense collision matrix over shipConfigs, built once by determineShipCollisions
+// bit c2 of shipCollisions[s1][s2][c1] is set if config index c1 of ship s1
+// and config index c2 of ship s2 share a square (filled for both s1 < s2 and s1 > s2)
+static uint64_t shipCollisions[5][5][MAX_SHIP_CONFIGS][CONFIG_WORDS];
+
+// random keys XORed together into the Zobrist hash of a board state (see
+// setSquare): one per square and status (0 for unguessed), and one per
+// ship and config id of its sinking
+static uint64_t zobristSquares[BOARD_SIDELENGTH * BOARD_SIDELENGTH][5];
+static uint64_t zobristSinkings[5][BOARD_SIDELENGTH * 100];
+static pthread_once_t shipTablesBuilt = PTHREAD_ONCE_INIT;
+
+/* ----- TYPES ----- */
+
+// one game and the move generator's state for it
+struct solver
+{
+    struct solverOptions options;
+
+    /**
+     * Board status
+     * 0 = padding square
+     * 1 = unguessed
+     * 2 = missed
+     * 3 = hit, not on a sunk ship
+     * 4 = hit, on a sunk ship
+     */
+    int S[BOARD_SIDELENGTH + 2 * BOARD_PADDING][BOARD_SIDELENGTH + 2 * BOARD_PADDING];
+
+    // keeps track of which ships are sunk
+    // ship order: 2,3,3,4,5
+    int sunken[5];
+    // keeps track of where sunken ships are
+    int sunkenLocations[5];
+    // Zobrist hash of S, sunken and sunkenLocations, kept up to date as
+    // they change (the key of the state in the move cache)
+    uint64_t zobristKey;
+
+    // stores the current # of guesses
+    int numGuesses;
+
+    // the configs still valid given the board status (not covering a missed
+    // square or a sunk ship), kept up to date by recordGuess/recordSinkage
+    // bit c is set if config c of ship s is still valid
+    uint64_t shipConfigBits[5][CONFIG_WORDS];
+    // the same configs as a list (in no particular order) and their #
+    int validShipConfigs[5][MAX_SHIP_CONFIGS];
+    int numValidShipConfigs[5];
+    // position of each valid config in validShipConfigs
+    int validShipConfigPositions[5][MAX_SHIP_CONFIGS];
+
+    // occupancy masks of the current board status
+    bitboard hitMask;  // hit, not on a sunk ship
+    bitboard missMask; // missed
+    bitboard sunkMask; // hit, on a sunk ship
+
+    // order in which bruteForceTestConfigs places the unsunk ships
+    // (fewest configs first) and the # of unsunk ships
+    int searchOrder[5];
+    int numSearchShips;
+    // union of the config masks / total length of searchOrder[d..numSearchShips-1]
+    bitboard searchCoverage[6];
+    int searchLength[6];
+
+    // wallTime() at which the current move's budget runs out, 0 for none
+    double moveDeadline;
+    // # of configs evaluated (sampled, or fully placed by the search) for the last move
+    long long configsEvaluated;
+
+    // stores the frequency of each ship config (indexed like shipConfigs) occuring
+    // given the remaining board configurations possible
+    long long shipPositionFrequencies[5][MAX_SHIP_CONFIGS];
+    // # of the valid boards covering each square, found by the last move
+    // (from shipPositionFrequencies or the move cache, 0 after a book move)
+    long long squareFrequencies[BOARD_SIDELENGTH * BOARD_SIDELENGTH];
+
+    // the valid boards sampled by randomlyTestConfigs, kept from one move to
+    // the next (with reuseSamples): 5 config indices per board, only
+    // meaningful for the ships unsunk when it was sampled
+    unsigned char *samplePool;
+    long long samplePoolSize;
+    // sunken[] as of the last time the pool was filtered
+    int samplePoolSunken[5];
+    // # of valid boards the first draw found (of maxConfigsTested configs,
+    // or fewer if the time budget ran out), which later uniform draws top
+    // the pool up to
+    long long samplePoolTarget;
+
+    // every valid board, kept by bruteForceTestConfigs when there are at
+    // most maxFleetsKept of them and filtered by each move after it, until
+    // a ship sinks (5 config indices each, like samplePool), NULL if they
+    // aren't kept
+    unsigned char *fleets;
+    long long numFleets;
+    // # of kept fleets using each config (counting one order of the twins
+    // while both are unsunk, like the search)
+    long long fleetFrequencies[5][MAX_SHIP_CONFIGS];
+
+    // the square of the guess whose answer is being speculated on, -1 for none,
+    // and the next move being generated for a miss (0) and for a hit (1);
+    // solverRecordGuess drops the one not matching the answer
+    int speculatedSquare;
+    struct speculativeMove *speculativeMoves[2];
+    // set (atomically) to stop the move being generated, as if its budget had run out
+    int cancelled;
+
+    // events of the moves since the last solverExportTrace (NULL without TRACE)
+    struct traceBuffer *trace;
+};
+
+// the next move for one answer to a guess, generated ahead of time on its
+// own thread (see solverSpeculate)
+struct speculativeMove
+{
+    struct solver solver;   // copy of the game, with the answer recorded
+    int move;               // the move generated, once finished
+    pthread_t thread;
+    pthread_mutex_t lock;   // guards finished and abandoned
+    int finished;           // 1 once the move is generated
+    int abandoned;          // 1 once nobody waits for it (whoever comes last frees it)
+    char *logBuffer;        // what the move logged, written to the real log if it's kept
+    size_t logSize;
+};
+
+// state of one depth-first search over the ship configs
+struct searchState
+{
+    int configs[5];                                 // config index chosen for each ship
+    long long frequencies[5][MAX_SHIP_CONFIGS];     // # of valid boards using each config
+    long long validConfigs;                         // # of valid boards found
+    long long tested;                               // # of boards evaluated
+    long long nodes;                                // # of placements the search tried (its work)
+    struct traceCounters counters;                  // what happened to them (only kept with TRACE)
+    unsigned char *boards;                          // with keepBoards, the valid boards found (5 config indices each)
+    long long numBoards;
+    long long boardCapacity;
+    long long boardLimit;                           // max # of boards kept, 0 for no limit
+    int keepBoards;
+    int boardsDropped;                              // 1 if the boards went over boardLimit and were dropped
+};
+
+// argument of the sampling and search tasks: the solver and the per-thread searchStates
+struct moveTasks
+{
+    struct solver *solver;
+    struct searchState *states;
+    long long numSamples;   // # of configs (or chain steps) the sampling tasks draw in all
+};
+
+// one group of ships for joinTestConfigs: every placement of the group's
+// ships in which they don't overlap each other (hits are ignored)
+struct shipGroup
+{
+    int ships[5];               // indices of the ships in the group
+    int numShips;
+    unsigned char *placements;  // numShips config indices per placement, in depth-first order
+    int numPlacements;
+    int words;                  // # of 64-bit words in a bitset over the placements
+    uint64_t *squarePlacements; // bitset of the placements covering square i, at i * words
+};
+
+// one pass of joinTestConfigs: each placement of one group (the rows) is
+// joined with all the placements of the other (the columns)
+struct joinPass
+{
+    struct solver *solver;
+    struct shipGroup *rows;
+    struct shipGroup *columns;
+    struct searchState *states; // per-thread counts
+    uint64_t *conflicts;        // per-thread scratch, rows->numShips + 1 bitsets over the columns
+    int countBoards;            // 1 if the pass counts the valid boards (only one of the two does)
+};
+
+/* ----- FUNCTION DECLARATIONS ----- */
+
+// builds the shared tables (once per process)
+static void buildShipTables(void);
+// fills in the Zobrist keys of every square status and sinking
+static void buildZobristKeys(void);
+// sets the status of a square, updating the Zobrist hash
+static inline void setSquare(struct solver *, int, int);
+// logs a message to the solver's log (if it has one)
+static void solverLog(struct solver *, const char *, ...);
+// generates a speculative move (thread entry point)
+static void *runSpeculativeMove(void *);
+// stops a speculative move and lets it free itself
+static void dropSpeculativeMove(struct speculativeMove *);
+// drops every speculative move of a solver
+static void cancelSpeculation(struct solver *);
+// frees a speculative move
+static void freeSpeculativeMove(struct speculativeMove *);
+// copies a list of boards (5 config indices each), NULL if there are none
+static unsigned char *copyBoards(const unsigned char *, long long);
+
+/* MOVE GENERATION FUNCTIONS */
+
+// Overarching move generation function; returns an integer in [0,99]
+static int generateMove(struct solver *);
+// Recomputes the hit/miss/sunk masks from the status matrix
+static void updateBoardMasks(struct solver *);
+// Generates all configurations for each ship on an empty board
+void generateShipConfigs(void);
+// Makes every ship config valid again (for a new game)
+static void resetShipConfigs(struct solver *);
+// Updates the board masks and valid ship configs after a guess
+static void recordGuess(struct solver *, int, int);
+// Updates the board masks and valid ship configs after a ship sinks
+static void recordSinkage(struct solver *, int, int);
+// Rules out every ship config covering a square
+static void removeShipConfigs(struct solver *, int);
+// Rules out one ship config
+static void removeShipConfig(struct solver *, int, int);
+// Rules out the ship configs that can't be part of a valid board, returns the # removed
+int propagateShipConfigs(struct solver *);
+// Returns if a ship config is compatible with the other ships and the hits
+static int configSupported(struct solver *, int, int);
+// Determines for all pairs of ship configs if the ships will collide
+void determineShipCollisions(void);
+// Returns if two ship configs collide (uses results from determineShipCollisions)
+static inline int shipConfigsCollide(int, int, int, int);
+// returns the # of boards in the product of the valid config lists
+double numConfigsToBeTested(struct solver *);
+// returns the opening book's move for the current position, -1 if it has none
+static int bookMove(struct solver *);
+// looks the current state up in the move cache
+static int cachedMove(struct solver *);
+// adds the current state and its move to the move cache
+static void cacheMove(struct solver *, int, long long);
+// tests if the given ship configuration is possible (given current board status)
+// takes an index into shipConfigs for each ship
+int validConfig(struct solver *, int[5]);
+// returns if two ships of a board overlap / if they cover all the hits (the two halves of validConfig)
+static int shipsIntersect(struct solver *, int[5]);
+static int hitsCovered(struct solver *, int[5]);
+// randomly tests maxConfigsTested configs (or fewer, reusing the boards of the last move)
+long long randomlyTestConfigs(struct solver *);
+// drops the pooled boards that no longer fit the board and counts the rest
+static long long filterSamplePool(struct solver *, struct searchState *);
+// drops every pooled board
+static void clearSamplePool(struct solver *);
+// counts every valid board by filtering the fleets kept from the last move
+static long long filterFleets(struct solver *);
+// drops the kept fleets
+static void clearFleets(struct solver *);
+// adds a valid board to a searchState's boards
+static void keepBoard(struct searchState *, int[5]);
+// adds the board a search just found to its boards, if it hasn't found too many for its work
+static inline void keepSearchBoard(struct searchState *);
+// drops a searchState's boards
+static void dropBoards(struct searchState *);
+// randomly tests one thread's share of maxConfigsTested configs (threadpool task)
+static void sampleTask(int, int, void *);
+// randomly tests the given # of configs
+static void sampleConfigs(struct solver *, struct searchState *, struct mtState *, long long);
+// samples one thread's share of valid boards with a hit-constrained chain (threadpool task)
+static void chainTask(int, int, void *);
+// runs the chain for the given # of steps, recording the board after each one
+static void chainConfigs(struct solver *, struct searchState *, struct mtState *, int[5], long long);
+// moves the chain one step, resampling one or two ships
+static void chainStep(struct solver *, struct mtState *, int[5]);
+// finds a random valid board with a randomized depth-first search
+static int findRandomBoard(struct solver *, struct mtState *, int, bitboard, uint64_t[5][CONFIG_WORDS], int[5]);
+// brute force tests all possible configs
+long long bruteForceTestConfigs(struct solver *);
+// keeps the valid boards found by bruteForceTestConfigs for the next moves
+static void keepFleets(struct solver *, struct searchState *);
+// sets up searchOrder, searchCoverage and searchLength for the search
+static void prepareSearch(struct solver *);
+// places the ship at the given depth in every possible config
+static void searchConfigs(struct solver *, struct searchState *, int, bitboard, uint64_t[5][CONFIG_WORDS]);
+// places the ship at the given depth in one config and recurses on the rest
+static void placeConfig(struct solver *, struct searchState *, int, int, bitboard, uint64_t[5][CONFIG_WORDS]);
+// counts the boards completed by every config of the last ship at once
+static void countLastShip(struct solver *, struct searchState *, int, bitboard, uint64_t[5][CONFIG_WORDS]);
+// checks if a placement can still lead to a valid board, blocking configs of the ships left
+static int canExtend(struct solver *, int, int, bitboard, uint64_t[5][CONFIG_WORDS], uint64_t[5][CONFIG_WORDS]);
+// returns if the ships left after a depth can't cover the remaining hits
+static inline int hitsOutOfReach(struct solver *, int, bitboard);
+// counts all remaining configs exactly by joining the placements of two groups of ships
+static long long joinTestConfigs(struct solver *);
+// adds every placement of the group's ships from the given depth on
+static int enumerateGroup(struct solver *, struct shipGroup *, int, unsigned char[5], uint64_t[5][CONFIG_WORDS], int *);
+// builds a group's bitsets of the placements covering each square
+static int indexGroup(struct shipGroup *);
+// joins one chunk of a group's placements with the other group (threadpool task)
+static void joinTask(int, int, void *);
+// searches every board with the first ship in the given config (threadpool task)
+static void searchTask(int, int, void *);
+// sums per-thread searchStates into shipPositionFrequencies, returns the # of valid boards
+static long long storeFrequencies(struct solver *, struct searchState *, int);
+// calculates and returns the best move after all ship frequencies have been determined
+int calculateBestMove(struct solver *, long long);
+
+/* HELPER/DEBUG FUNCTIONS */
+
+// returns the occupancy mask of a ship of the given length and config
+static bitboard configMask(int, int);
+// returns the # of squares set in a mask
+static inline int bitboardCount(bitboard);
+// returns the # of bits set in a config bitset
+static inline int bitsetCount(uint64_t[CONFIG_WORDS]);
+// returns 1 if the ship is one of the two interchangeable length-3 ships
+static inline int isTwinShip(int);
+// returns 1 if both twin ships are unsunk (so they can be swapped on any board)
+static inline int twinShipsUnsunk(struct solver *);
+// returns word w of the config bitset holding configs 0 to c
+static inline uint64_t configsUpTo(int, int);
+// returns the # of bits set in a bitset of any length
+static long long bitsetPopcount(const uint64_t *, int);
+// returns the index of the k-th (from 0) bit set in a config bitset
+static int bitsetSelect(uint64_t[CONFIG_WORDS], int);
+// fills a bitset with the configs of a ship that cover all the given squares
+static void coveringConfigs(struct solver *, int, bitboard, uint64_t[CONFIG_WORDS]);
+// returns 1 if the current move's time budget has run out (or it was cancelled), 0 otherwise
+static int deadlinePassed(struct solver *);
+// returns 1 if the current move was cancelled, 0 otherwise
+static inline int moveCancelled(struct solver *);
+// returns a random integer in [0, n) from a random number stream
+static inline uint32_t randomBelow(struct mtState *, uint32_t);
+
+/* ----- CODE ----- */
+
+/* API FUNCTIONS */
+
+/**
+ * Fills in the default options: one thread, a seed of 0, no time budget,
+ * sampling for large states (reusing the samples of the last move), keeping
+ * up to 4M enumerated boards (20 MB) for the next moves, no opening book,
+ * no move cache and no log
+ * 
+ * @param options the options to fill in
+ */
+void solverDefaultOptions(struct solverOptions *options)
+{
+    options->numThreads = 1;
+    options->randomSeed = 0;
+    options->moveTimeBudgetMs = 0;
+    options->exactJoin = 0;
+    options->maxConfigsTested = 10000000;
+    options->maxChainSamples = 500000;
+    options->maxConfigsEnumerated = 1000000000.0;
+    options->reuseSamples = 1;
+    options->maxFleetsKept = 4000000;
+    options->book = NULL;
+    options->cache = NULL;
+    options->log = NULL;
+}
+
+/**
+ * Creates a solver with the given options, ready for a new game
+ * (builds the shared tables the first time it is called)
+ * 
+ * @param options the options (copied), or NULL for the defaults
+ * @return the solver, or NULL if it couldn't be allocated
+ */
+struct solver *solverCreate(const struct solverOptions *options)
+{
+    pthread_once(&shipTablesBuilt, buildShipTables);
+
+    struct solver *solver = malloc(sizeof(struct solver));
+    if (solver == NULL)
+        return NULL;
+
+    if (options != NULL)
+        solver->options = *options;
+    else
+        solverDefaultOptions(&solver->options);
+    if (solver->options.numThreads < 1)
+        solver->options.numThreads = 1;
+
+    solver->speculatedSquare = -1;
+    solver->speculativeMoves[0] = solver->speculativeMoves[1] = NULL;
+    solver->cancelled = 0;
+    solver->samplePool = NULL;
+    solver->samplePoolSize = 0;
+    solver->fleets = NULL;
+    solver->numFleets = 0;
+    solver->trace = NULL;
+#if TRACE
+    // (a move is generated all the same if its events can't be kept)
+    solver->trace = traceBufferCreate();
+#endif
+
+    solverNewGame(solver);
+
+    return solver;
+}
+
+/**
+ * Frees a solver (speculative moves still running free themselves)
+ */
+void solverDestroy(struct solver *solver)
+{
+    cancelSpeculation(solver);
+    free(solver->samplePool);
+    free(solver->fleets);
+    traceBufferDestroy(solver->trace);
+    free(solver);
+}
+
+/**
+ * Starts a new game: clears the board and makes every ship config valid
+ */
+void solverNewGame(struct solver *solver)
+{
+    cancelSpeculation(solver);
+
+    solver->numGuesses = 0;
+
+    // no ships are sunk yet
+    for (int s = 0; s < 5; s++)
+    {
+        solver->sunken[s] = 0;
+        solver->sunkenLocations[s] = 0;
+    }
+    solver->zobristKey = 0;
+
+    // set all padding squares to 0 (padding)
+    for (int x = 0; x < BOARD_SIDELENGTH + 2 * BOARD_PADDING; x++)
+    {
+        for (int y = 0; y < BOARD_SIDELENGTH + 2 * BOARD_PADDING; y++)
+            solver->S[x][y] = 0;
+    }
+    // set all board squares to 1 (unguessed)
+    for (int x = BOARD_PADDING; x < BOARD_SIDELENGTH + BOARD_PADDING; x++)
+    {
+        for (int y = BOARD_PADDING; y < BOARD_SIDELENGTH + BOARD_PADDING; y++)
+            solver->S[x][y] = 1;
+    }
+
+    // the valid ship configs are kept for the whole game and updated as
+    // guesses come in
+    updateBoardMasks(solver);
+    resetShipConfigs(solver);
+    solver->configsEvaluated = 0;
+    memset(solver->shipPositionFrequencies, 0, sizeof(solver->shipPositionFrequencies));
+    memset(solver->squareFrequencies, 0, sizeof(solver->squareFrequencies));
+    clearSamplePool(solver);
+    solver->samplePoolTarget = 0;
+    clearFleets(solver);
+}
+
+/**
+ * Sets up a game in the given state, as if its guesses had been
+ * recorded one by one
+ * 
+ * @param status status of each square (y * 10 + x), as returned by
+ *               solverSquare: 1 unguessed, 2 missed, 3 hit, 4 hit on a sunk ship
+ * @param sunk config id (y, x, o) of each sunk ship, -1 for each unsunk one
+ * @return 0 on success, 1 if the state is invalid (the solver is then
+ *         left with a new game)
+ */
+int solverLoadBoard(struct solver *solver, const int status[BOARD_SIDELENGTH * BOARD_SIDELENGTH], const int sunk[5])
+{
+    solverNewGame(solver);
+
+    for (int square = 0; square < BOARD_SIDELENGTH * BOARD_SIDELENGTH; square++)
+    {
+        if (status[square] < 1 || status[square] > 4)
+        {
+            solverNewGame(solver);
+            return 1;
+        }
+
+        setSquare(solver, square, status[square]);
+        if (status[square] != 1)
+            solver->numGuesses++;
+        if (status[square] == 2)
+            removeShipConfigs(solver, square);
+    }
+    updateBoardMasks(solver);
+
+    for (int s = 0; s < 5; s++)
+    {
+        if (sunk[s] < 0)
+            continue;
+
+        bitboard mask = configMask(shipLengths[s], sunk[s]);
+        if ((mask & solver->sunkMask) != mask)
+        {
+            solverNewGame(solver);
+            return 1;
+        }
+
+        solver->sunken[s] = 1;
+        solver->sunkenLocations[s] = sunk[s];
+        solver->zobristKey ^= zobristSinkings[s][sunk[s]];
+        recordSinkage(solver, s, sunk[s]);
+    }
+
+    return 0;
+}
+
+/**
+ * Generates the next guess (counting it as a guess)
+ * 
+ * @return the square to guess (y * 10 + x), or -1 if no board is
+ *         consistent with the guesses so far (or there wasn't enough
+ *         memory to search them)
+ */
+int solverNextMove(struct solver *solver)
+{
+    // take the speculative move kept by solverRecordGuess, if there is one
+    struct speculativeMove *speculative = solver->speculatedSquare < 0 ? solver->speculativeMoves[1] : NULL;
+    solver->speculativeMoves[1] = NULL;
+    cancelSpeculation(solver);
+
+    if (speculative != NULL)
+    {
+        pthread_join(speculative->thread, NULL);
+
+        // the copy went through the same steps as this solver would have,
+        // so it takes its place as is (keeping this solver's options; its
+        // trace holds the move's events)
+        struct solverOptions options = solver->options;
+        free(solver->samplePool);
+        free(solver->fleets);
+        traceBufferDestroy(solver->trace);
+        *solver = speculative->solver;
+        solver->options = options;
+
+        if (speculative->logBuffer != NULL)
+        {
+            if (options.log != NULL)
+                fwrite(speculative->logBuffer, 1, speculative->logSize, options.log);
+            free(speculative->logBuffer);
+        }
+        int move = speculative->move;
+        pthread_mutex_destroy(&speculative->lock);
+        free(speculative);
+
+        return move;
+    }
+
+    solver->numGuesses++;
+    return generateMove(solver);
+}
+
+/**
+ * Generates the next guess for a game in the given state
+ * (solverLoadBoard followed by solverNextMove)
+ * 
+ * @return the square to guess, or -1 if the state is invalid or no
+ *         board is consistent with it
+ */
+int solverMove(struct solver *solver, const int status[BOARD_SIDELENGTH * BOARD_SIDELENGTH], const int sunk[5])
+{
+    if (solverLoadBoard(solver, status, sunk))
+        return -1;
+    return solverNextMove(solver);
+}
+
+/**
+ * Records the answer to a guess
+ * 
+ * @param square the square guessed (y * 10 + x)
+ * @param hit 1 for a hit, 0 for a miss
+ * @return 0 on success, 1 if the square isn't on the board or was already guessed
+ */
+int solverRecordGuess(struct solver *solver, int square, int hit)
+{
+    if (square < 0 || square >= BOARD_SIDELENGTH * BOARD_SIDELENGTH ||
+        solver->S[square / 10 + BOARD_PADDING][square % 10 + BOARD_PADDING] != 1)
+        return 1;
+
+    setSquare(solver, square, hit ? 3 : 2);
+    recordGuess(solver, square, hit);
+
+    // keep the speculative move for this answer (in speculativeMoves[1]
+    // for solverNextMove) and drop the other one
+    struct speculativeMove *kept = NULL;
+    if (solver->speculatedSquare == square)
+    {
+        kept = solver->speculativeMoves[hit ? 1 : 0];
+        solver->speculativeMoves[hit ? 1 : 0] = NULL;
+    }
+    cancelSpeculation(solver);
+    solver->speculativeMoves[1] = kept;
+
+    return 0;
+}
+
+/**
+ * Starts generating the next move for both answers to a guess (a miss and
+ * a hit on the square), each on a background thread and its own copy of
+ * the game, while the answer is awaited. solverRecordGuess on the square
+ * keeps the move for the answer given and cancels the other, and the next
+ * solverNextMove returns it (waiting for it if it isn't ready yet). Any
+ * other change to the game cancels both.
+ * 
+ * Each move uses numThreads threads and the same random streams as it
+ * would have afterwards, so it's the same move (unless there's a time
+ * budget, which then starts running right away).
+ * 
+ * @param square the square guessed (y * 10 + x)
+ * @return 0 on success, 1 if the square can't be guessed or a thread
+ *         couldn't be started (solverNextMove then works as usual)
+ */
+int solverSpeculate(struct solver *solver, int square)
+{
+    cancelSpeculation(solver);
+
+    if (square < 0 || square >= BOARD_SIDELENGTH * BOARD_SIDELENGTH ||
+        solver->S[square / 10 + BOARD_PADDING][square % 10 + BOARD_PADDING] != 1)
+        return 1;
+
+    for (int hit = 0; hit <= 1; hit++)
+    {
+        struct speculativeMove *speculative = malloc(sizeof(struct speculativeMove));
+        if (speculative == NULL)
+        {
+            cancelSpeculation(solver);
+            return 1;
+        }
+
+        speculative->solver = *solver;
+        speculative->solver.speculativeMoves[0] = speculative->solver.speculativeMoves[1] = NULL;
+        speculative->solver.cancelled = 0;
+        // (each copy filters and tops up its own pool, and filters its own fleets)
+        speculative->solver.samplePool = copyBoards(solver->samplePool, solver->samplePoolSize);
+        if (speculative->solver.samplePool == NULL)
+            speculative->solver.samplePoolSize = 0;
+        speculative->solver.fleets = copyBoards(solver->fleets, solver->numFleets);
+        if (speculative->solver.fleets == NULL)
+            speculative->solver.numFleets = 0;
+        speculative->solver.trace = NULL;
+#if TRACE
+        speculative->solver.trace = traceBufferCreate();
+#endif
+        speculative->finished = 0;
+        speculative->abandoned = 0;
+        pthread_mutex_init(&speculative->lock, NULL);
+
+        // the log is held back until the answer decides if the move is kept
+        speculative->logBuffer = NULL;
+        speculative->logSize = 0;
+        speculative->solver.options.log = NULL;
+        if (solver->options.log != NULL)
+            speculative->solver.options.log = open_memstream(&speculative->logBuffer, &speculative->logSize);
+
+        struct solver *copy = &speculative->solver;
+        setSquare(copy, square, hit ? 3 : 2);
+        recordGuess(copy, square, hit);
+
+        if (pthread_create(&speculative->thread, NULL, runSpeculativeMove, speculative) != 0)
+        {
+            if (copy->options.log != NULL)
+                fclose(copy->options.log);
+            freeSpeculativeMove(speculative);
+            cancelSpeculation(solver);
+            return 1;
+        }
+        solver->speculativeMoves[hit] = speculative;
+    }
+    solver->speculatedSquare = square;
+
+    return 0;
+}
+
+/**
+ * Records a sunk ship
+ * 
+ * @param s index of the ship (ship order: 2,3,3,4,5)
+ * @param config config id of the ship (y * 100 + x * 10 + o, o = 0 for
+ *               up and 1 for right, from its bottom or left square)
+ * @return 0 on success, 1 if the ship is already sunk, doesn't fit on the
+ *         board or covers a square not recorded as a hit
+ */
+int solverRecordSinkage(struct solver *solver, int s, int config)
+{
+    if (s < 0 || s >= 5 || solver->sunken[s])
+        return 1;
+
+    int x = config / 10 % 10, y = config / 100, o = config % 10;
+    int shipLength = shipLengths[s];
+    if (config < 0 || o > 1 || y >= BOARD_SIDELENGTH || (o == 0 ? y : x) + shipLength > BOARD_SIDELENGTH)
+        return 1;
+
+    // every square of the ship must have been recorded as a hit (on no sunk ship)
+    bitboard mask = configMask(shipLength, config);
+    if ((mask & solver->hitMask) != mask)
+        return 1;
+
+    // (a rejected sinkage doesn't change the game, so the speculative
+    // moves are only dropped now)
+    cancelSpeculation(solver);
+
+    solver->sunken[s] = 1;
+    solver->sunkenLocations[s] = config;
+    solver->zobristKey ^= zobristSinkings[s][config];
+
+    // set the squares in the status matrix
+    for (int square = 0; square < BOARD_SIDELENGTH * BOARD_SIDELENGTH; square++)
+    {
+        if ((mask >> square) & 1)
+            setSquare(solver, square, 4);
+    }
+    recordSinkage(solver, s, config);
+
+    return 0;
+}
+
+/**
+ * Returns the status of a square (y * 10 + x): 1 unguessed, 2 missed,
+ * 3 hit (not on a sunk ship), 4 hit on a sunk ship
+ */
+int solverSquare(const struct solver *solver, int square)
+{
+    return solver->S[square / 10 + BOARD_PADDING][square % 10 + BOARD_PADDING];
+}
+
+/**
+ * Returns 1 if ship s is sunk, 0 otherwise
+ */
+int solverShipSunk(const struct solver *solver, int s)
+{
+    return solver->sunken[s];
+}
+
+/**
+ * Returns the # of guesses made so far
+ */
+int solverNumGuesses(const struct solver *solver)
+{
+    return solver->numGuesses;
+}
+
+/**
+ * Determine if the game is won (all ships have been sunk)
+ * @return 1 if won, 0 otherwise
+ */
+int solverGameOver(const struct solver *solver)
+{
+    for (int s = 0; s < 5; s++)
+        if (!solver->sunken[s])
+            return 0;
+    return 1;
+}
+
+/**
+ * Returns the # of configs evaluated for the last move
+ */
+long long solverConfigsEvaluated(const struct solver *solver)
+{
+    return solver->configsEvaluated;
+}
+
+/**
+ * Returns the # of valid boards (counted or sampled) the last move found
+ * covering a square (y * 10 + x), 0 after a move from the opening book
+ */
+long long solverSquareFrequency(const struct solver *solver, int square)
+{
+    return solver->squareFrequencies[square];
+}
+
+/**
+ * Writes the events (spans and counters) recorded for the moves generated
+ * since the last export to a Chrome trace JSON file, and clears them
+ * (only when built with TRACE, see trace.h)
+ * 
+ * @param path the file to write
+ * @return 0 on success, 1 if there are no events kept (without TRACE) or
+ *         the file couldn't be written
+ */
+int solverExportTrace(struct solver *solver, const char *path)
+{
+    return traceExport(solver->trace, path);
+}
+
+/**
+ * Returns the # of configs of ship s on an empty board
+ */
+int solverNumShipConfigs(int s)
+{
+    pthread_once(&shipTablesBuilt, buildShipTables);
+    return numShipConfigs[s];
+}
+
+/**
+ * Returns config id (y, x, o) of config index c of ship s on an empty
+ * board (the same for every solver)
+ */
+int solverShipConfig(int s, int c)
+{
+    pthread_once(&shipTablesBuilt, buildShipTables);
+    return shipConfigs[s][c];
+}
+
+/* INTERNAL FUNCTIONS (see solver_internal.h) */
+
+/**
+ * Counts a guess without generating its move, as solverNextMove does
+ * before generating one
+ */
+void countGuess(struct solver *solver)
+{
+    solver->numGuesses++;
+}
+
+/**
+ * Returns the # of configs of ship s still valid
+ */
+int numValidConfigs(const struct solver *solver, int s)
+{
+    return solver->numValidShipConfigs[s];
+}
+
+/**
+ * Returns the i-th config still valid of ship s (an index into its
+ * configs, in no particular order)
+ */
+int validShipConfig(const struct solver *solver, int s, int i)
+{
+    return solver->validShipConfigs[s][i];
+}
+
+/* MOVE GENERATION FUNCTIONS */
+
+/**
+ * Builds the tables shared by all solvers: the configs of each ship on an
+ * empty board and their collisions, and the Zobrist keys
+ */
+static void buildShipTables(void)
+{
+    generateShipConfigs();
+    determineShipCollisions();
+    buildZobristKeys();
+}
+
+/**
+ * Fills in the Zobrist keys from a fixed seed, so that a state has the
+ * same hash in every solver (and every run); an unguessed square has
+ * the key 0, so a new game hashes to 0
+ */
+static void buildZobristKeys(void)
+{
+    struct mtState rng;
+    init_genrand_r(&rng, ZOBRIST_SEED);
+
+    for (int square = 0; square < BOARD_SIDELENGTH * BOARD_SIDELENGTH; square++)
+    {
+        for (int status = 2; status <= 4; status++)
+            zobristSquares[square][status] = (uint64_t)genrand_int32_r(&rng) << 32 | genrand_int32_r(&rng);
+    }
+    for (int s = 0; s < 5; s++)
+    {
+        for (int config = 0; config < BOARD_SIDELENGTH * 100; config++)
+            zobristSinkings[s][config] = (uint64_t)genrand_int32_r(&rng) << 32 | genrand_int32_r(&rng);
+    }
+}
+
+/**
+ * Sets the status of a square (y * 10 + x) in the status matrix,
+ * swapping its old status's key for the new one's in the Zobrist hash
+ */
+static inline void setSquare(struct solver *solver, int square, int status)
+{
+    int *cell = &solver->S[square / 10 + BOARD_PADDING][square % 10 + BOARD_PADDING];
+    solver->zobristKey ^= zobristSquares[square][*cell] ^ zobristSquares[square][status];
+    *cell = status;
+}
+
+/**
+ * Generates the move of a speculativeMove, then frees it if it was
+ * dropped in the meantime
+ * 
+ * @param arg the speculativeMove
+ */
+static void *runSpeculativeMove(void *arg)
+{
+    struct speculativeMove *speculative = arg;
+    struct solver *solver = &speculative->solver;
+
+    solver->numGuesses++;
+    speculative->move = generateMove(solver);
+
+    // (the buffer and its size are only valid once the stream is closed)
+    if (solver->options.log != NULL)
+        fclose(solver->options.log);
+    solver->options.log = NULL;
+
+    pthread_mutex_lock(&speculative->lock);
+    speculative->finished = 1;
+    int abandoned = speculative->abandoned;
+    pthread_mutex_unlock(&speculative->lock);
+
+    if (abandoned)
+        freeSpeculativeMove(speculative);
+
+    return NULL;
+}
+
+/**
+ * Cancels a speculative move without waiting for it: it stops at its next
+ * deadline check (or runs to the end if its engine doesn't check) and is
+ * freed by whichever of it and this function comes last
+ */
+static void dropSpeculativeMove(struct speculativeMove *speculative)
+{
+    __atomic_store_n(&speculative->solver.cancelled, 1, __ATOMIC_RELAXED);
+    pthread_detach(speculative->thread);
+
+    pthread_mutex_lock(&speculative->lock);
+    speculative->abandoned = 1;
+    int finished = speculative->finished;
+    pthread_mutex_unlock(&speculative->lock);
+
+    if (finished)
+        freeSpeculativeMove(speculative);
+}
+
+/**
+ * Frees a speculative move that isn't running (or no longer used)
+ */
+static void freeSpeculativeMove(struct speculativeMove *speculative)
+{
+    free(speculative->solver.samplePool);
+    free(speculative->solver.fleets);
+    traceBufferDestroy(speculative->solver.trace);
+    free(speculative->logBuffer);
+    pthread_mutex_destroy(&speculative->lock);
+    free(speculative);
+}
+
+/**
+ * Copies a list of boards (5 config indices each) for a speculative move
+ * 
+ * @return the copy, or NULL if there are no boards or it couldn't be allocated
+ */
+static unsigned char *copyBoards(const unsigned char *boards, long long numBoards)
+{
+    if (boards == NULL || numBoards == 0)
+        return NULL;
+
+    unsigned char *copy = malloc(numBoards * 5);
+    if (copy != NULL)
+        memcpy(copy, boards, numBoards * 5);
+    return copy;
+}
+
+/**
+ * Drops every speculative move of the solver (the game changed)
+ */
+static void cancelSpeculation(struct solver *solver)
+{
+    for (int hit = 0; hit <= 1; hit++)
+    {
+        if (solver->speculativeMoves[hit] != NULL)
+            dropSpeculativeMove(solver->speculativeMoves[hit]);
+        solver->speculativeMoves[hit] = NULL;
+    }
+    solver->speculatedSquare = -1;
+}
+
+/**
+ * Writes a message to the solver's log, if it has one (printf-style)
+ */
+static void solverLog(struct solver *solver, const char *format, ...)
+{
+    if (solver->options.log == NULL)
+        return;
+
+    va_list args;
+    va_start(args, format);
+    vfprintf(solver->options.log, format, args);
+    va_end(args);
+}
+
+
+/**
+ * Recomputes hitMask, missMask and sunkMask from the status matrix
+ */
+static void updateBoardMasks(struct solver *solver)
+{
+    solver->hitMask = 0;
+    solver->missMask = 0;
+    solver->sunkMask = 0;
+
+    for (int y = 0; y < BOARD_SIDELENGTH; y++)
+    {
+        for (int x = 0; x < BOARD_SIDELENGTH; x++)
+        {
+            bitboard square = (bitboard)1 << (y * 10 + x);
+
+            switch (solver->S[y + BOARD_PADDING][x + BOARD_PADDING])
+            {
+            case 2:
+                solver->missMask |= square;
+                break;
+            case 3:
+                solver->hitMask |= square;
+                break;
+            case 4:
+                solver->sunkMask |= square;
+                break;
+            }
+        }
+    }
+
+    return;
+}
+
+/**
+ * Generates all configs for each ship on an empty board
+ * Iterates over every single square / every ship / every orientation (up or right)
+ * 
+ * A ship config is any placement that stays on the board. Called once
+ * (see buildShipTables); each solver starts a game with every config
+ * valid (resetShipConfigs) and recordGuess/recordSinkage rule them out
+ * from then on.
+ */
+void generateShipConfigs(void)
+{
+    // resetting numShipConfigs array and the square bitsets
+    for (int i = 0; i < 5; i++)
+        numShipConfigs[i] = 0;
+    memset(shipSquareConfigs, 0, sizeof(shipSquareConfigs));
+
+    for (int x = 0; x < BOARD_SIDELENGTH; x++)
+    {
+        for (int y = 0; y < BOARD_SIDELENGTH; y++)
+        {
+            // for each spot on the board
+
+            int indexMultiplied = (y * 10 + x) * 10; // index of the space in 0-99, *10
+
+            for (int s = 4; s >= 0; s--)
+            {
+                int shipLength = shipLengths[s];
+
+                /* up (0) and right (1) */
+                for (int o = 0; o < 2; o++)
+                {
+                    // ship would go off the board
+                    if ((o == 0 ? y : x) + shipLength > BOARD_SIDELENGTH)
+                        continue;
+
+                    int config = indexMultiplied + o;
+                    int c = numShipConfigs[s]++;
+                    shipConfigs[s][c] = config;
+                    shipConfigMasks[s][c] = 0;
+
+                    for (int l = 0; l < shipLength; l++)
+                    {
+                        int square = y * 10 + x + (o == 0 ? 10 * l : l);
+                        shipConfigSquares[s][c][l] = square;
+                        shipConfigMasks[s][c] |= (bitboard)1 << square;
+                        shipSquareConfigs[s][square][c >> 6] |= (uint64_t)1 << (c & 63);
+                    }
+                }
+            }
+        }
+    }
+
+    return;
+}
+
+/**
+ * Makes every config of every ship valid again, for a new game
+ */
+static void resetShipConfigs(struct solver *solver)
+{
+    memset(solver->shipConfigBits, 0, sizeof(solver->shipConfigBits));
+
+    for (int s = 0; s < 5; s++)
+    {
+        solver->numValidShipConfigs[s] = numShipConfigs[s];
+        for (int c = 0; c < numShipConfigs[s]; c++)
+        {
+            solver->shipConfigBits[s][c >> 6] |= (uint64_t)1 << (c & 63);
+            solver->validShipConfigs[s][c] = c;
+            solver->validShipConfigPositions[s][c] = c;
+        }
+    }
+
+    return;
+}
+
+/**
+ * Records the result of a guess: a hit only changes hitMask, while a
+ * miss also rules out every ship config covering the square
+ * 
+ * @param square the square guessed, in [0,99]
+ * @param hit 1 for a hit, 0 for a miss
+ */
+static void recordGuess(struct solver *solver, int square, int hit)
+{
+    bitboard bit = (bitboard)1 << square;
+
+    if (hit)
+        solver->hitMask |= bit;
+    else
+    {
+        solver->missMask |= bit;
+        removeShipConfigs(solver, square);
+    }
+
+    return;
+}
+
+/**
+ * Records a sunk ship: its squares stop counting as hits to be covered
+ * and every ship config covering one of them is ruled out
+ * 
+ * @param s index of the ship
+ * @param config config id of the ship (y, x, o)
+ */
+static void recordSinkage(struct solver *solver, int s, int config)
+{
+    bitboard mask = configMask(shipLengths[s], config);
+
+    // searching without the ship (and its hits) is far cheaper than
+    // filtering the fleets kept with it
+    clearFleets(solver);
+
+    solver->hitMask &= ~mask;
+    solver->missMask &= ~mask;
+    solver->sunkMask |= mask;
+
+    for (int square = 0; square < BOARD_SIDELENGTH * BOARD_SIDELENGTH; square++)
+    {
+        if ((mask >> square) & 1)
+            removeShipConfigs(solver, square);
+    }
+
+    return;
+}
+
+/**
+ * Rules out every still valid ship config covering a square, removing
+ * it from shipConfigBits and validShipConfigs. Only touches the configs
+ * removed, so the cost scales with the change rather than the board.
+ * 
+ * @param square the square, in [0,99]
+ */
+static void removeShipConfigs(struct solver *solver, int square)
+{
+    for (int s = 0; s < 5; s++)
+    {
+        for (int w = 0; w < CONFIG_WORDS; w++)
+        {
+            uint64_t removed = solver->shipConfigBits[s][w] & shipSquareConfigs[s][square][w];
+
+            while (removed)
+            {
+                removeShipConfig(solver, s, w * 64 + __builtin_ctzll(removed));
+                removed &= removed - 1;
+            }
+        }
+    }
+
+    return;
+}
+
+/**
+ * Rules out a single still valid config of a ship
+ * 
+ * @param s index of the ship
+ * @param c config index of the ship
+ */
+static void removeShipConfig(struct solver *solver, int s, int c)
+{
+    solver->shipConfigBits[s][c / 64] &= ~((uint64_t)1 << (c % 64));
+
+    // move the last valid config into its place
+    int position = solver->validShipConfigPositions[s][c];
+    int last = solver->validShipConfigs[s][--solver->numValidShipConfigs[s]];
+    solver->validShipConfigs[s][position] = last;
+    solver->validShipConfigPositions[s][last] = position;
+
+    return;
+}
+
+/**
+ * Rules out the ship configs that can't be part of any valid board, by
+ * arc consistency: a config of an unsunk ship is kept only if
+ * 1. every other unsunk ship has a config left that doesn't collide with it
+ * 2. every hit it doesn't cover can be covered by another unsunk ship's
+ *    config that doesn't collide with it
+ * Removing a config can take away the only support of another one, so
+ * this repeats until nothing changes.
+ * 
+ * As guesses only ever rule boards out, a config removed here never
+ * becomes valid again, so the removal is permanent (like removeShipConfigs).
+ * 
+ * @return the # of configs removed
+ */
+int propagateShipConfigs(struct solver *solver)
+{
+    int removed = 0;
+    int changed = 1;
+
+    while (changed)
+    {
+        changed = 0;
+        for (int s = 0; s < 5; s++)
+        {
+            if (solver->sunken[s])
+                continue;
+
+            for (int w = 0; w < CONFIG_WORDS; w++)
+            {
+                for (uint64_t bits = solver->shipConfigBits[s][w]; bits; bits &= bits - 1)
+                {
+                    int c = w * 64 + __builtin_ctzll(bits);
+                    if (!configSupported(solver, s, c))
+                    {
+                        removeShipConfig(solver, s, c);
+                        removed++;
+                        changed = 1;
+                    }
+                }
+            }
+        }
+    }
+
+    return removed;
+}
+
+/**
+ * Checks if config c of ship s still has support from the other unsunk
+ * ships (see propagateShipConfigs)
+ * 
+ * @param s index of the ship
+ * @param c config index of the ship
+ * @return 1 if the config is supported, 0 otherwise
+ */
+static int configSupported(struct solver *solver, int s, int c)
+{
+    // for each other unsunk ship, its configs that don't collide with c
+    uint64_t compatible[5][CONFIG_WORDS];
+
+    for (int t = 0; t < 5; t++)
+    {
+        if (t == s || solver->sunken[t])
+            continue;
+
+        uint64_t any = 0;
+        for (int v = 0; v < CONFIG_WORDS; v++)
+        {
+            compatible[t][v] = solver->shipConfigBits[t][v] & ~shipCollisions[s][t][c][v];
+            any |= compatible[t][v];
+        }
+        if (any == 0)
+            return 0;
+    }
+
+    bitboard uncovered = solver->hitMask & ~shipConfigMasks[s][c];
+    while (uncovered)
+    {
+        uint64_t low = (uint64_t)uncovered;
+        int square = low ? __builtin_ctzll(low) : 64 + __builtin_ctzll((uint64_t)(uncovered >> 64));
+        uncovered &= uncovered - 1;
+
+        uint64_t covering = 0;
+        for (int t = 0; t < 5; t++)
+        {
+            if (t == s || solver->sunken[t])
+                continue;
+            for (int v = 0; v < CONFIG_WORDS; v++)
+                covering |= compatible[t][v] & shipSquareConfigs[t][square][v];
+        }
+        if (covering == 0)
+            return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Determines which ship configurations collide with each other
+ * Iterates over each pair of 2 ship configurations and stores
+ * setups that collide in the shipCollisions bit matrix
+ * 
+ * This prevents the program from having to test the same pair
+ * of configurations over and over again during the board
+ * configuration generation phase. Configs are never removed from
+ * shipConfigs, so this only has to be done once (see buildShipTables).
+ */
+void determineShipCollisions(void)
+{
+    for (int s1 = 0; s1 < 5; s1++)
+    { // ship 1
+        for (int s2 = 0; s2 < 5; s2++)
+        { // ship 2
+            if (s1 == s2)
+                continue;
+
+            for (int c1 = 0; c1 < numShipConfigs[s1]; c1++)
+            { // iterate through ship 1 configs
+                uint64_t *row = shipCollisions[s1][s2][c1];
+                bitboard ship1Mask = shipConfigMasks[s1][c1];
+
+                for (int w = 0; w < CONFIG_WORDS; w++)
+                    row[w] = 0;
+
+                for (int c2 = 0; c2 < numShipConfigs[s2]; c2++)
+                { // iterate through ship 2 configs
+                    if (ship1Mask & shipConfigMasks[s2][c2])
+                        row[c2 >> 6] |= (uint64_t)1 << (c2 & 63);
+                }
+            }
+        }
+    }
+    return;
+}
+
+/**
+ * Returns if two ships collide in a specific configuration
+ * 
+ * @param s1 index of the first ship
+ * @param s2 index of the second ship
+ * @param c1 config index of the first ship (into shipConfigs)
+ * @param c2 config index of the second ship (into shipConfigs)
+ * 
+ * @return 1 if the ships collide, 0 otherwise
+ */
+static inline int shipConfigsCollide(int s1, int s2, int c1, int c2)
+{
+    return (shipCollisions[s1][s2][c1][c2 >> 6] >> (c2 & 63)) & 1;
+}
+
+/**
+ * Returns the amount of configurations to be tested in a round
+ * (AKA # of configs for each ship multiplied together)
+ */
+double numConfigsToBeTested(struct solver *solver)
+{
+    double num = 1;
+    for (int i = 0; i < 5; i++)
+    {
+        if (!solver->sunken[i]) num *= solver->numValidShipConfigs[i];
+    }
+    return num;
+}
+
+/**
+ * Looks the current position up in the opening book (which only has
+ * positions without a sunk ship)
+ * 
+ * @return the book's move, or -1 if there's no book, the position isn't
+ *         in it, or its move isn't an unguessed square
+ */
+static int bookMove(struct solver *solver)
+{
+    if (solver->options.book == NULL)
+        return -1;
+    for (int s = 0; s < 5; s++)
+    {
+        if (solver->sunken[s])
+            return -1;
+    }
+
+    uint64_t hits[2] = {(uint64_t)solver->hitMask, (uint64_t)(solver->hitMask >> 64)};
+    uint64_t misses[2] = {(uint64_t)solver->missMask, (uint64_t)(solver->missMask >> 64)};
+    int move = bookLookup(solver->options.book, hits, misses);
+    if (move < 0 || solver->S[move / 10 + BOARD_PADDING][move % 10 + BOARD_PADDING] != 1)
+        return -1;
+
+    return move;
+}
+
+/**
+ * Looks the current state up in the move cache, restoring the square
+ * frequencies found for it
+ * 
+ * @return the cached move (-1 if no board fits the state), or -2 if
+ *         there's no cache or the state isn't in it
+ */
+static int cachedMove(struct solver *solver)
+{
+    if (solver->options.cache == NULL)
+        return -2;
+
+    struct moveCacheEntry entry;
+    if (!moveCacheGet(solver->options.cache, solver->zobristKey, &entry))
+        return -2;
+
+    memcpy(solver->squareFrequencies, entry.frequencies, sizeof(solver->squareFrequencies));
+    return entry.move;
+}
+
+/**
+ * Adds the current state, its move and the square frequencies found for
+ * it to the move cache (if there is one)
+ * 
+ * @param move the move generated
+ * @param validConfigs # of valid boards it was generated from
+ */
+static void cacheMove(struct solver *solver, int move, long long validConfigs)
+{
+    if (solver->options.cache == NULL)
+        return;
+
+    struct moveCacheEntry entry;
+    entry.key = solver->zobristKey;
+    entry.move = move;
+    entry.validConfigs = validConfigs;
+    memcpy(entry.frequencies, solver->squareFrequencies, sizeof(entry.frequencies));
+    moveCachePut(solver->options.cache, &entry);
+}
+
+/**
+ * Overall function for generating the next move
+ */
+static int generateMove(struct solver *solver)
+{
+    solverLog(solver, "Generating move...\n");
+
+    int move = bookMove(solver);
+    if (move >= 0)
+    {
+        solverLog(solver, "Move taken from the opening book: %d\n", move);
+        solver->configsEvaluated = 0;
+        memset(solver->squareFrequencies, 0, sizeof(solver->squareFrequencies));
+        return move;
+    }
+
+    move = cachedMove(solver);
+    if (move != -2)
+    {
+        solverLog(solver, "Move taken from the cache: %d\n", move);
+        solver->configsEvaluated = 0;
+        return move;
+    }
+
+    double startTime = wallTime(); // store START time (wall clock, moves may use several threads)
+    solver->moveDeadline = solver->options.moveTimeBudgetMs > 0 ? startTime + solver->options.moveTimeBudgetMs / 1000.0 : 0;
+
+    TRACE_SPAN_BEGIN(moveStart);
+
+    int numConfigsBefore[5];
+    for (int i = 0; i < 5; i++)
+        numConfigsBefore[i] = solver->numValidShipConfigs[i];
+
+    TRACE_SPAN_BEGIN(propagateStart);
+    propagateShipConfigs(solver);
+    TRACE_SPAN_END(solver->trace, propagateStart, "propagateShipConfigs", 0);
+
+    if (DEBUG)
+    {
+        solverLog(solver, "Printing # of valid ship configs (before propagation):\n");
+        for (int i = 0; i < 5; i++)
+        {
+            solverLog(solver, "Ship %d: %d config(s) (%d)\n", i, solver->numValidShipConfigs[i], numConfigsBefore[i]);
+        }
+    }
+
+    long long validConfigs = 0;
+
+    double configsToBeTested = numConfigsToBeTested(solver);
+
+    TRACE_SPAN_BEGIN(testStart);
+    if (solver->fleets != NULL) {
+        if (DEBUG) solverLog(solver, "Filtering kept boards\n");
+        validConfigs = filterFleets(solver);
+        TRACE_SPAN_END(solver->trace, testStart, "filterFleets", 0);
+        if (validConfigs < 0)
+            solverLog(solver, "Not enough memory to filter the kept boards, searching again\n");
+    }
+
+    // (filterFleets drops the fleets if it fails)
+    if (solver->fleets != NULL) {
+        // counted by filterFleets
+    } else if (configsToBeTested > solver->options.maxConfigsEnumerated && solver->options.exactJoin) {
+        if (DEBUG) solverLog(solver, "Join testing configs\n");
+        clearSamplePool(solver);
+        validConfigs = joinTestConfigs(solver);
+        TRACE_SPAN_END(solver->trace, testStart, "joinTestConfigs", 0);
+        if (validConfigs < 0)
+        {
+            solverLog(solver, "Not enough memory to join the placements, sampling instead\n");
+            validConfigs = randomlyTestConfigs(solver);
+        }
+    } else if (configsToBeTested > solver->options.maxConfigsEnumerated) {
+        if (DEBUG) solverLog(solver, "Randomly testing configs\n");
+        validConfigs = randomlyTestConfigs(solver);
+        TRACE_SPAN_END(solver->trace, testStart, "randomlyTestConfigs", 0);
+    } else {
+        if (DEBUG) solverLog(solver, "Brute force testing configs\n");
+        clearSamplePool(solver);
+        validConfigs = bruteForceTestConfigs(solver);
+        TRACE_SPAN_END(solver->trace, testStart, "bruteForceTestConfigs", 0);
+        if (deadlinePassed(solver))
+            solverLog(solver, "Time budget ran out, using a partial enumeration\n");
+    }
+
+    if (validConfigs < 0)
+    {
+        solverLog(solver, "Not enough memory to generate a move\n");
+        memset(solver->squareFrequencies, 0, sizeof(solver->squareFrequencies));
+        TRACE_SPAN_END(solver->trace, moveStart, "generateMove", 0);
+        return -1;
+    }
+
+    double endTime = wallTime(); // store END time
+
+    solverLog(solver, "Time taken: %fs, %lld configs evaluated\n", endTime - startTime, solver->configsEvaluated);
+
+    if (DEBUG) 
+        solverLog(solver, "\n# valid configs: %lld out of %lld\n", validConfigs, solver->configsEvaluated);
+
+    TRACE_SPAN_BEGIN(bestMoveStart);
+    move = calculateBestMove(solver, validConfigs);
+    TRACE_SPAN_END(solver->trace, bestMoveStart, "calculateBestMove", 0);
+
+    if (DEBUG)
+        solverLog(solver, "\nBest move calculated, was %d\n", move);
+
+    // (a cancelled move is cut short, and never played)
+    if (!moveCancelled(solver))
+        cacheMove(solver, move, validConfigs);
+
+    TRACE_SPAN_END(solver->trace, moveStart, "generateMove", 0);
+
+    return move;
+}
+
+/**
+ * Randomly generates and tests maxConfigsTested configs
+ * Used when the # of remaining configs is more than maxConfigsEnumerated
+ * 
+ * The samples are split into numThreads tasks, each drawing from its own
+ * Mersenne Twister stream seeded from (randomSeed, numGuesses, task), so
+ * a move is reproducible for a given seed and # of threads.
+ * 
+ * With a time budget, each task also stops at the first deadline check
+ * (every SAMPLE_CHUNK configs) after the budget runs out, so the result
+ * depends on timing.
+ * 
+ * Once there are hits on the board, almost all uniformly drawn configs
+ * miss one of them, so valid boards are drawn with chainTask instead.
+ * 
+ * With reuseSamples, the valid boards found are kept in the solver's
+ * samplePool. The boards of a uniform sample that fit the guesses made
+ * since are a uniform sample of the boards that are still valid, so the
+ * next move only filters the pool (see filterSamplePool) and draws as
+ * many new configs as it takes to bring it back to the size of the first
+ * draw (or maxChainSamples, with hits): usually none for a while
+ * after each miss, and far fewer than a full draw after a hit.
+ * 
+ * @return the # of valid boards found, or -1 if the per-thread
+ *         searchStates couldn't be allocated
+ */
+long long randomlyTestConfigs(struct solver *solver)
+{
+    int numThreads = solver->options.numThreads;
+    int reuse = solver->options.reuseSamples;
+    struct searchState *states = calloc(numThreads, sizeof(struct searchState));
+    if (states == NULL)
+        return -1;
+    struct moveTasks tasks = {solver, states, 0};
+
+    long long poolSize = reuse ? filterSamplePool(solver, states) : 0;
+    if (!reuse)
+        clearSamplePool(solver);
+    for (int t = 0; t < numThreads; t++)
+        states[t].keepBoards = reuse;
+
+    if (solver->hitMask != 0)
+    {
+        tasks.numSamples = poolSize < solver->options.maxChainSamples ? solver->options.maxChainSamples - poolSize : 0;
+        if (tasks.numSamples > 0)
+        {
+            prepareSearch(solver);
+            runParallel(numThreads, numThreads, chainTask, &tasks);
+        }
+    }
+    else
+    {
+        // (a full draw until the pool has been filled once)
+        long long target = solver->samplePoolTarget;
+        if (target == 0 || poolSize == 0)
+            tasks.numSamples = solver->options.maxConfigsTested;
+        else if (poolSize < target)
+            tasks.numSamples = (long long)((double)solver->options.maxConfigsTested * (target - poolSize) / target);
+        if (tasks.numSamples > 0)
+            runParallel(numThreads, numThreads, sampleTask, &tasks);
+
+        // (however far the budget let the first draw get)
+        if (reuse && target == 0)
+        {
+            for (int t = 0; t < numThreads; t++)
+                solver->samplePoolTarget += states[t].numBoards;
+        }
+    }
+
+    if (reuse)
+    {
+        // add the new boards to the pool
+        long long numNew = 0, numDrawn = 0;
+        for (int t = 0; t < numThreads; t++)
+        {
+            numNew += states[t].numBoards;
+            numDrawn += states[t].tested;
+        }
+        if (numNew > 0)
+        {
+            unsigned char *pool = realloc(solver->samplePool, (solver->samplePoolSize + numNew) * 5);
+            if (pool != NULL)
+            {
+                solver->samplePool = pool;
+                for (int t = 0; t < numThreads; t++)
+                {
+                    memcpy(pool + solver->samplePoolSize * 5, states[t].boards, states[t].numBoards * 5);
+                    solver->samplePoolSize += states[t].numBoards;
+                }
+            }
+        }
+        solverLog(solver, "Reused %lld sampled board(s), drew %lld new config(s)\n", poolSize, numDrawn);
+    }
+
+    long long validConfigs = storeFrequencies(solver, states, solver->options.numThreads);
+    for (int t = 0; t < numThreads; t++)
+        free(states[t].boards);
+    free(states);
+
+    return validConfigs;
+}
+
+/**
+ * Drops the boards of the sample pool that no longer fit the board (a
+ * ship covering a square since missed, or not covering one since hit,
+ * or a ship since sunk somewhere else) and counts the others in a
+ * searchState, as if they had just been sampled
+ * 
+ * A ship sunk since is matched against either twin while both were
+ * unsunk (the board then stands for both orders, see storeFrequencies),
+ * swapping them if needed.
+ * 
+ * @param state where the boards left are counted
+ * @return the # of boards left in the pool
+ */
+static long long filterSamplePool(struct solver *solver, struct searchState *state)
+{
+    // config index of each ship sunk since the pool was last filtered, -1 for the others
+    int sunkConfigs[5];
+    for (int s = 0; s < 5; s++)
+    {
+        sunkConfigs[s] = -1;
+        if (solver->sunken[s] && !solver->samplePoolSunken[s])
+        {
+            for (int c = 0; c < numShipConfigs[s]; c++)
+            {
+                if (shipConfigs[s][c] == solver->sunkenLocations[s])
+                    sunkConfigs[s] = c;
+            }
+        }
+    }
+
+    long long numKept = 0;
+    for (long long b = 0; b < solver->samplePoolSize; b++)
+    {
+        unsigned char *board = solver->samplePool + b * 5;
+        int configs[5];
+        for (int s = 0; s < 5; s++)
+            configs[s] = board[s];
+
+        int fits = 1;
+        for (int s = 0; s < 5 && fits; s++)
+        {
+            if (sunkConfigs[s] < 0 || configs[s] == sunkConfigs[s])
+                continue;
+
+            int twin = 3 - s; // (1 <-> 2)
+            if (isTwinShip(s) && !solver->samplePoolSunken[twin] && configs[twin] == sunkConfigs[s])
+            {
+                configs[twin] = configs[s];
+                configs[s] = sunkConfigs[s];
+            }
+            else
+                fits = 0;
+        }
+        for (int s = 0; s < 5 && fits; s++)
+        {
+            if (!solver->sunken[s] && !((solver->shipConfigBits[s][configs[s] / 64] >> (configs[s] % 64)) & 1))
+                fits = 0;
+        }
+        if (!fits || !hitsCovered(solver, configs))
+            continue;
+
+        unsigned char *kept = solver->samplePool + numKept * 5;
+        for (int s = 0; s < 5; s++)
+        {
+            kept[s] = configs[s];
+            if (!solver->sunken[s])
+                state->frequencies[s][configs[s]]++;
+        }
+        numKept++;
+    }
+
+    state->validConfigs += numKept;
+    state->tested += solver->samplePoolSize;
+    TRACE_COUNT(state->counters.candidates, solver->samplePoolSize);
+    TRACE_COUNT(state->counters.accepted, numKept);
+
+    solver->samplePoolSize = numKept;
+    for (int s = 0; s < 5; s++)
+        solver->samplePoolSunken[s] = solver->sunken[s];
+
+    return numKept;
+}
+
+/**
+ * Drops every board of the sample pool
+ */
+static void clearSamplePool(struct solver *solver)
+{
+    free(solver->samplePool);
+    solver->samplePool = NULL;
+    solver->samplePoolSize = 0;
+    for (int s = 0; s < 5; s++)
+        solver->samplePoolSunken[s] = solver->sunken[s];
+}
+
+/**
+ * Counts every valid board exactly from the fleets kept by an earlier
+ * bruteForceTestConfigs (instead of searching for them again)
+ * 
+ * The valid boards only ever get fewer as guesses come in, so the fleets
+ * that no longer fit the board (a ship covering a square since missed, or
+ * none covering a square since hit) are dropped in place and taken off
+ * fleetFrequencies, which then holds the counts of the boards left.
+ * 
+ * @return the # of valid boards, or -1 if its searchState couldn't be
+ *         allocated (the fleets are then dropped, to be searched again)
+ */
+static long long filterFleets(struct solver *solver)
+{
+    struct searchState *state = calloc(1, sizeof(struct searchState));
+    if (state == NULL)
+    {
+        clearFleets(solver);
+        return -1;
+    }
+
+    // (no ship sinks while the fleets are kept, see recordSinkage)
+    int ships[5], numShips = 0;
+    for (int s = 0; s < 5; s++)
+    {
+        if (!solver->sunken[s])
+            ships[numShips++] = s;
+    }
+
+    long long numKept = 0;
+    for (long long b = 0; b < solver->numFleets; b++)
+    {
+        unsigned char *fleet = solver->fleets + b * 5;
+        bitboard covered = 0;
+        for (int i = 0; i < numShips; i++)
+            covered |= shipConfigMasks[ships[i]][fleet[ships[i]]];
+
+        if ((covered & solver->missMask) == 0 && (solver->hitMask & ~covered) == 0)
+        {
+            memmove(solver->fleets + numKept * 5, fleet, 5);
+            numKept++;
+        }
+        else
+        {
+            for (int i = 0; i < numShips; i++)
+                solver->fleetFrequencies[ships[i]][fleet[ships[i]]]--;
+        }
+    }
+
+    memcpy(state->frequencies, solver->fleetFrequencies, sizeof(state->frequencies));
+    state->validConfigs = numKept;
+    state->tested = solver->numFleets;
+    TRACE_COUNT(state->counters.candidates, solver->numFleets);
+    TRACE_COUNT(state->counters.accepted, numKept);
+    solver->numFleets = numKept;
+
+    long long validConfigs = storeFrequencies(solver, state, 1);
+    free(state);
+
+    return validConfigs;
+}
+
+/**
+ * Drops the kept fleets (the next small enough state is searched again)
+ */
+static void clearFleets(struct solver *solver)
+{
+    free(solver->fleets);
+    solver->fleets = NULL;
+    solver->numFleets = 0;
+}
+
+/**
+ * Adds a valid board to a searchState's boards (growing them as needed)
+ * 
+ * If there would be more than boardLimit boards (or they can't be grown),
+ * they are all dropped and no more are kept.
+ * 
+ * @param configs config index of each ship
+ */
+static void keepBoard(struct searchState *state, int configs[5])
+{
+    if (state->boardLimit > 0 && state->numBoards == state->boardLimit)
+    {
+        dropBoards(state);
+        return;
+    }
+
+    if (state->numBoards == state->boardCapacity)
+    {
+        long long capacity = state->boardCapacity > 0 ? state->boardCapacity * 2 : 4096;
+        unsigned char *boards = realloc(state->boards, capacity * 5);
+        if (boards == NULL)
+        {
+            dropBoards(state);
+            return;
+        }
+        state->boards = boards;
+        state->boardCapacity = capacity;
+    }
+
+    unsigned char *board = state->boards + state->numBoards * 5;
+    for (int s = 0; s < 5; s++)
+        board[s] = configs[s];
+    state->numBoards++;
+}
+
+/**
+ * Adds the board a search just found (in state->configs) to its boards,
+ * unless it has found too many for the work it did: past FLEETS_PER_NODE
+ * boards per search node, filtering them would cost the next move more
+ * than searching again, so they are all dropped
+ */
+static inline void keepSearchBoard(struct searchState *state)
+{
+    if (state->numBoards >= FLEETS_PER_NODE * state->nodes + KEPT_FLEETS_SLACK)
+        dropBoards(state);
+    else
+        keepBoard(state, state->configs);
+}
+
+/**
+ * Drops a searchState's boards and stops keeping them
+ */
+static void dropBoards(struct searchState *state)
+{
+    free(state->boards);
+    state->boards = NULL;
+    state->numBoards = state->boardCapacity = 0;
+    state->keepBoards = 0;
+    state->boardsDropped = 1;
+}
+
+/**
+ * Randomly tests one task's share of the maxConfigsTested configs
+ * 
+ * @param task index of the task (and its random number stream)
+ * @param thread index of the thread running the task
+ * @param arg the moveTasks
+ */
+static void sampleTask(int task, int thread, void *arg)
+{
+    struct solver *solver = ((struct moveTasks *)arg)->solver;
+    struct searchState *state = ((struct moveTasks *)arg)->states + thread;
+
+    struct mtState rng;
+    unsigned long key[3] = {solver->options.randomSeed, solver->numGuesses, task};
+    init_by_array_r(&rng, key, 3);
+
+    TRACE_SPAN_BEGIN(spanStart);
+
+    long long numSamples = ((struct moveTasks *)arg)->numSamples;
+    long long first = numSamples * task / solver->options.numThreads;
+    long long last = numSamples * (task + 1) / solver->options.numThreads;
+    // (in chunks, to stop early if the move is cancelled or, once there's
+    // a chunk to go on, if the budget runs out)
+    for (long long i = first; i < last; i += SAMPLE_CHUNK)
+    {
+        if (i > first ? deadlinePassed(solver) : moveCancelled(solver))
+            break;
+        sampleConfigs(solver, state, &rng, last - i < SAMPLE_CHUNK ? last - i : SAMPLE_CHUNK);
+    }
+
+    TRACE_SPAN_END(solver->trace, spanStart, "sampleTask", thread);
+
+    return;
+}
+
+/**
+ * Randomly tests the given # of configs
+ * 
+ * @param state where valid boards are recorded
+ * @param rng the random number stream to draw from
+ * @param numSamples # of configs to test
+ */
+static void sampleConfigs(struct solver *solver, struct searchState *state, struct mtState *rng, long long numSamples)
+{
+    for (long long i = 0; i < numSamples; i++)
+    {
+        int testedShipConfigs[5] = {0}; // randomly selected ship config indices
+
+        // randomly select a config for each of the 5 ships (if not sunken)
+        for (int j = 0; j < 5; j++)
+        {
+            if (!solver->sunken[j])
+                testedShipConfigs[j] = solver->validShipConfigs[j][randomBelow(rng, solver->numValidShipConfigs[j])];
+        }
+
+        // if the set of 5 generated ship configs is valid (see validConfig),
+        // count the frequency of each ship config
+        if (shipsIntersect(solver, testedShipConfigs))
+        {
+            TRACE_COUNT(state->counters.collisions, 1);
+        }
+        else if (!hitsCovered(solver, testedShipConfigs))
+        {
+            TRACE_COUNT(state->counters.uncoveredHits, 1);
+        }
+        else
+        {
+            state->validConfigs++;
+            for (int s = 0; s < 5; s++)
+            {
+                if (!solver->sunken[s])
+                    state->frequencies[s][testedShipConfigs[s]]++;
+            }
+            if (state->keepBoards)
+                keepBoard(state, testedShipConfigs);
+            TRACE_COUNT(state->counters.accepted, 1);
+        }
+    }
+    state->tested += numSamples;
+    TRACE_COUNT(state->counters.candidates, numSamples);
+
+    return;
+}
+
+/**
+ * Samples one task's share of maxChainSamples valid boards
+ * 
+ * The boards come from a Markov chain over the valid boards: each step
+ * picks two of the unsunk ships and redraws their configs together,
+ * uniformly among the pairs that keep the board valid (no collisions,
+ * every hit covered) given the other ships. The uniform distribution
+ * over valid boards is stationary, so after CHAIN_BURN_IN steps the
+ * recorded boards estimate the same frequencies as rejection sampling,
+ * without ever drawing an invalid board. Redrawing two ships at once
+ * lets the chain change which ship covers a hit.
+ * 
+ * @param task index of the task (and its random number stream)
+ * @param thread index of the thread running the task
+ * @param arg the moveTasks
+ */
+static void chainTask(int task, int thread, void *arg)
+{
+    struct solver *solver = ((struct moveTasks *)arg)->solver;
+    struct searchState *state = ((struct moveTasks *)arg)->states + thread;
+
+    struct mtState rng;
+    unsigned long key[3] = {solver->options.randomSeed, solver->numGuesses, task};
+    init_by_array_r(&rng, key, 3);
+
+    TRACE_SPAN_BEGIN(spanStart);
+
+    // start the chain from any valid board
+    int configs[5] = {0};
+    uint64_t blocked[5][CONFIG_WORDS] = {{0}};
+    if (!findRandomBoard(solver, &rng, 0, 0, blocked, configs))
+        return;
+
+    for (int i = 0; i < CHAIN_BURN_IN; i++)
+        chainStep(solver, &rng, configs);
+
+    long long numSamples = ((struct moveTasks *)arg)->numSamples;
+    long long first = numSamples * task / solver->options.numThreads;
+    long long last = numSamples * (task + 1) / solver->options.numThreads;
+    // (like sampleTask, at least one chunk with a time budget)
+    for (long long i = first; i < last; i += CHAIN_CHUNK)
+    {
+        if (i > first ? deadlinePassed(solver) : moveCancelled(solver))
+            break;
+        chainConfigs(solver, state, &rng, configs, last - i < CHAIN_CHUNK ? last - i : CHAIN_CHUNK);
+    }
+
+    TRACE_SPAN_END(solver->trace, spanStart, "chainTask", thread);
+
+    return;
+}
+
+/**
+ * Runs the chain for the given # of steps, counting the board after each one
+ * 
+ * @param state where the boards are recorded
+ * @param rng the random number stream to draw from
+ * @param configs the current board (config index of each ship), updated
+ * @param numSamples # of steps
+ */
+static void chainConfigs(struct solver *solver, struct searchState *state, struct mtState *rng, int configs[5], long long numSamples)
+{
+    for (long long i = 0; i < numSamples; i++)
+    {
+        chainStep(solver, rng, configs);
+
+        state->validConfigs++;
+        for (int d = 0; d < solver->numSearchShips; d++)
+            state->frequencies[solver->searchOrder[d]][configs[solver->searchOrder[d]]]++;
+        if (state->keepBoards)
+            keepBoard(state, configs);
+    }
+    state->tested += numSamples;
+    // (every board the chain visits is valid)
+    TRACE_COUNT(state->counters.candidates, numSamples);
+    TRACE_COUNT(state->counters.accepted, numSamples);
+
+    return;
+}
+
+/**
+ * Moves the chain one step: redraws the configs of two random unsunk
+ * ships (or the only one) uniformly among those that keep the board valid
+ * 
+ * @param rng the random number stream to draw from
+ * @param configs the current board (config index of each ship), updated
+ */
+static void chainStep(struct solver *solver, struct mtState *rng, int configs[5])
+{
+    int a = solver->searchOrder[randomBelow(rng, solver->numSearchShips)];
+    int b = -1;
+    if (solver->numSearchShips > 1)
+    {
+        b = solver->searchOrder[randomBelow(rng, solver->numSearchShips - 1)];
+        if (b == a)
+            b = solver->searchOrder[solver->numSearchShips - 1];
+    }
+
+    // squares of the ships that stay, and the hits they leave uncovered
+    bitboard others = 0;
+    for (int d = 0; d < solver->numSearchShips; d++)
+    {
+        int t = solver->searchOrder[d];
+        if (t != a && t != b)
+            others |= shipConfigMasks[t][configs[t]];
+    }
+    bitboard needed = solver->hitMask & ~others;
+
+    // configs of a and b that don't collide with the ships that stay
+    uint64_t allowedA[CONFIG_WORDS], allowedB[CONFIG_WORDS];
+    for (int w = 0; w < CONFIG_WORDS; w++)
+    {
+        allowedA[w] = solver->shipConfigBits[a][w];
+        if (b != -1)
+            allowedB[w] = solver->shipConfigBits[b][w];
+    }
+    for (int d = 0; d < solver->numSearchShips; d++)
+    {
+        int t = solver->searchOrder[d];
+        if (t == a || t == b)
+            continue;
+        for (int w = 0; w < CONFIG_WORDS; w++)
+        {
+            allowedA[w] &= ~shipCollisions[t][a][configs[t]][w];
+            if (b != -1)
+                allowedB[w] &= ~shipCollisions[t][b][configs[t]][w];
+        }
+    }
+
+    if (b == -1)
+    {
+        // a single ship has to cover all the hits left
+        uint64_t covering[CONFIG_WORDS];
+        coveringConfigs(solver, a, needed, covering);
+        for (int w = 0; w < CONFIG_WORDS; w++)
+            allowedA[w] &= covering[w];
+
+        int count = bitsetCount(allowedA);
+        if (count > 0)
+            configs[a] = bitsetSelect(allowedA, randomBelow(rng, count));
+        return;
+    }
+
+    // configs of b that could go with a config of a covering none of the needed hits
+    uint64_t allowedNeeded[CONFIG_WORDS];
+    coveringConfigs(solver, b, needed, allowedNeeded);
+    for (int w = 0; w < CONFIG_WORDS; w++)
+        allowedNeeded[w] &= allowedB[w];
+
+    // for every config of a, count the configs of b that go with it
+    int candidates[MAX_SHIP_CONFIGS];
+    int weights[MAX_SHIP_CONFIGS];
+    int numCandidates = 0;
+    long long total = 0;
+
+    for (int w = 0; w < CONFIG_WORDS; w++)
+    {
+        uint64_t bits = allowedA[w];
+        while (bits)
+        {
+            int ca = w * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+
+            uint64_t pairs[CONFIG_WORDS];
+            if (needed & shipConfigMasks[a][ca])
+            {
+                coveringConfigs(solver, b, needed & ~shipConfigMasks[a][ca], pairs);
+                for (int v = 0; v < CONFIG_WORDS; v++)
+                    pairs[v] &= allowedB[v];
+            }
+            else
+            {
+                for (int v = 0; v < CONFIG_WORDS; v++)
+                    pairs[v] = allowedNeeded[v];
+            }
+            for (int v = 0; v < CONFIG_WORDS; v++)
+                pairs[v] &= ~shipCollisions[a][b][ca][v];
+
+            int count = bitsetCount(pairs);
+            if (count > 0)
+            {
+                candidates[numCandidates] = ca;
+                weights[numCandidates] = count;
+                numCandidates++;
+                total += count;
+            }
+        }
+    }
+
+    // the current pair always qualifies, so total > 0
+    if (total == 0)
+        return;
+
+    long long r = randomBelow(rng, total);
+    int i = 0;
+    while (r >= weights[i])
+        r -= weights[i++];
+
+    int ca = candidates[i];
+    uint64_t pairs[CONFIG_WORDS];
+    coveringConfigs(solver, b, needed & ~shipConfigMasks[a][ca], pairs);
+    for (int v = 0; v < CONFIG_WORDS; v++)
+        pairs[v] &= allowedB[v] & ~shipCollisions[a][b][ca][v];
+
+    configs[a] = ca;
+    configs[b] = bitsetSelect(pairs, r);
+
+    return;
+}
+
+/**
+ * Finds a random valid board: like searchConfigs, but tries the configs
+ * of each ship in random order and stops at the first valid board
+ * (requires prepareSearch to have been called)
+ * 
+ * @param rng the random number stream to draw from
+ * @param depth # of ships already placed
+ * @param occupied squares covered by the ships already placed
+ * @param blocked for each ship, the configs colliding with a placed ship
+ * @param configs filled with the config index of each ship
+ * @return 1 if a valid board was found, 0 otherwise
+ */
+static int findRandomBoard(struct solver *solver, struct mtState *rng, int depth, bitboard occupied, uint64_t blocked[5][CONFIG_WORDS], int configs[5])
+{
+    int s = solver->searchOrder[depth];
+
+    int candidates[MAX_SHIP_CONFIGS];
+    int numCandidates = 0;
+    for (int i = 0; i < solver->numValidShipConfigs[s]; i++)
+    {
+        int c = solver->validShipConfigs[s][i];
+        if (!((blocked[s][c >> 6] >> (c & 63)) & 1))
+            candidates[numCandidates++] = c;
+    }
+
+    while (numCandidates > 0)
+    {
+        // take a random candidate out of the list
+        int i = randomBelow(rng, numCandidates);
+        int c = candidates[i];
+        candidates[i] = candidates[--numCandidates];
+
+        bitboard newOccupied = occupied | shipConfigMasks[s][c];
+        bitboard remainingHits = solver->hitMask & ~newOccupied;
+        configs[s] = c;
+
+        if (depth + 1 == solver->numSearchShips)
+        {
+            if (remainingHits == 0)
+                return 1;
+            continue;
+        }
+
+        uint64_t newBlocked[5][CONFIG_WORDS];
+        if (canExtend(solver, depth, c, remainingHits, blocked, newBlocked) &&
+            findRandomBoard(solver, rng, depth + 1, newOccupied, newBlocked, configs))
+            return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Brute force generates and tests all remaining configs
+ * Used when the # of remaining configs is less than maxConfigsEnumerated
+ * 
+ * Rather than testing the full product of the ship config lists, places
+ * one ship at a time (depth-first) and abandons a partial placement as
+ * soon as it can't lead to a valid board, so that every valid board is
+ * still counted exactly once.
+ * 
+ * The configs of the first ship placed are split across numThreads
+ * threads, each counting into its own searchState; the counts are summed
+ * afterwards, so the result doesn't depend on the # of threads.
+ * 
+ * If the move's time budget runs out, every thread stops after its next
+ * valid board and the boards found so far are used.
+ * 
+ * If there are at most maxFleetsKept valid boards (and the search wasn't
+ * cut short), they are kept for filterFleets, which counts them for the
+ * moves after this one. That only pays off when the search does a lot of
+ * work per board (typically once there are hits to cover), so they are
+ * dropped as soon as there are more than FLEETS_PER_NODE per search node.
+ * 
+ * @return the # of valid boards found, or -1 if the per-thread
+ *         searchStates couldn't be allocated
+ */
+long long bruteForceTestConfigs(struct solver *solver)
+{
+    prepareSearch(solver);
+
+    struct searchState *states = calloc(solver->options.numThreads, sizeof(struct searchState));
+    if (states == NULL)
+        return -1;
+    struct moveTasks tasks = {solver, states, 0};
+
+    int keep = solver->options.maxFleetsKept > 0 && solver->numSearchShips > 0;
+    for (int t = 0; t < solver->options.numThreads; t++)
+    {
+        states[t].keepBoards = keep;
+        states[t].boardLimit = solver->options.maxFleetsKept;
+    }
+
+    if (solver->numSearchShips == 0)
+    {
+        uint64_t blocked[5][CONFIG_WORDS] = {{0}};
+        searchConfigs(solver, states, 0, 0, blocked);
+    }
+    else
+        runParallel(solver->options.numThreads, solver->numValidShipConfigs[solver->searchOrder[0]], searchTask, &tasks);
+
+    if (keep)
+        keepFleets(solver, states);
+
+    long long validConfigs = storeFrequencies(solver, states, solver->options.numThreads);
+    for (int t = 0; t < solver->options.numThreads; t++)
+        free(states[t].boards);
+    free(states);
+
+    return validConfigs;
+}
+
+/**
+ * Gathers the valid boards found by each thread of bruteForceTestConfigs
+ * into the solver's fleets, with their counts, unless there were too many
+ * of them or the search was cut short
+ * 
+ * @param states the per-thread searchStates
+ */
+static void keepFleets(struct solver *solver, struct searchState *states)
+{
+    long long numFleets = 0;
+    for (int t = 0; t < solver->options.numThreads; t++)
+    {
+        if (states[t].boardsDropped)
+            return;
+        numFleets += states[t].numBoards;
+    }
+    if (numFleets == 0 || numFleets > solver->options.maxFleetsKept || deadlinePassed(solver))
+        return;
+
+    clearFleets(solver);
+    solver->fleets = malloc(numFleets * 5);
+    if (solver->fleets == NULL)
+        return;
+    memset(solver->fleetFrequencies, 0, sizeof(solver->fleetFrequencies));
+    for (int t = 0; t < solver->options.numThreads; t++)
+    {
+        memcpy(solver->fleets + solver->numFleets * 5, states[t].boards, states[t].numBoards * 5);
+        solver->numFleets += states[t].numBoards;
+        for (int s = 0; s < 5; s++)
+        {
+            for (int c = 0; c < numShipConfigs[s]; c++)
+                solver->fleetFrequencies[s][c] += states[t].frequencies[s][c];
+        }
+    }
+    solverLog(solver, "Kept %lld valid board(s) for the next moves\n", numFleets);
+}
+
+/**
+ * Searches every board that has the first ship (searchOrder[0]) in the
+ * given valid config
+ * 
+ * @param task position of the first ship's config in validShipConfigs
+ * @param thread index of the thread running the task
+ * @param arg the moveTasks
+ */
+static void searchTask(int task, int thread, void *arg)
+{
+    struct solver *solver = ((struct moveTasks *)arg)->solver;
+    struct searchState *state = ((struct moveTasks *)arg)->states + thread;
+    int c = solver->validShipConfigs[solver->searchOrder[0]][task];
+
+    if (state->validConfigs > 0 && deadlinePassed(solver))
+        return;
+
+    TRACE_SPAN_BEGIN(spanStart);
+
+    // nothing is blocked before any ship is placed
+    uint64_t blocked[5][CONFIG_WORDS] = {{0}};
+    placeConfig(solver, state, 0, c, 0, blocked);
+
+    TRACE_SPAN_END(solver->trace, spanStart, "searchTask", thread);
+
+    return;
+}
+
+/**
+ * Orders the unsunk ships by # of configs (fewest first, so the search
+ * tree branches as late as possible) and precomputes, for each depth,
+ * which squares and how many squares the ships not yet placed can cover
+ */
+static void prepareSearch(struct solver *solver)
+{
+    solver->numSearchShips = 0;
+    for (int s = 0; s < 5; s++)
+    {
+        if (solver->sunken[s])
+            continue;
+
+        // insertion sort on the # of configs
+        int d = solver->numSearchShips++;
+        while (d > 0 && solver->numValidShipConfigs[solver->searchOrder[d - 1]] > solver->numValidShipConfigs[s])
+        {
+            solver->searchOrder[d] = solver->searchOrder[d - 1];
+            d--;
+        }
+        solver->searchOrder[d] = s;
+    }
+
+    solver->searchCoverage[solver->numSearchShips] = 0;
+    solver->searchLength[solver->numSearchShips] = 0;
+    for (int d = solver->numSearchShips - 1; d >= 0; d--)
+    {
+        int s = solver->searchOrder[d];
+
+        bitboard coverage = 0;
+        for (int i = 0; i < solver->numValidShipConfigs[s]; i++)
+            coverage |= shipConfigMasks[s][solver->validShipConfigs[s][i]];
+
+        solver->searchCoverage[d] = solver->searchCoverage[d + 1] | coverage;
+        solver->searchLength[d] = solver->searchLength[d + 1] + shipLengths[s];
+    }
+
+    return;
+}
+
+/**
+ * Tries every config of ship searchOrder[depth] that doesn't collide with
+ * the ships already placed, and recurses on the ships after it
+ * (the last ship is counted by countLastShip instead).
+ * 
+ * @param state where valid boards are recorded
+ * @param depth # of ships already placed
+ * @param occupied squares covered by the ships already placed
+ * @param blocked for each ship, the configs colliding with a placed ship
+ */
+static void searchConfigs(struct solver *solver, struct searchState *state, int depth, bitboard occupied, uint64_t blocked[5][CONFIG_WORDS])
+{
+    if (solver->numSearchShips == 0)
+    {
+        // every ship is sunk; the (only) board is valid if no hits are left
+        if ((solver->hitMask & ~occupied) == 0)
+            state->validConfigs++;
+        return;
+    }
+
+    int s = solver->searchOrder[depth];
+
+    // out of time (but keep going until there's something to go on)
+    if (depth <= 1 && state->validConfigs > 0 && deadlinePassed(solver))
+        return;
+
+    if (depth + 1 == solver->numSearchShips)
+    {
+        countLastShip(solver, state, depth, occupied, blocked);
+        return;
+    }
+
+    for (int w = 0; w * 64 < numShipConfigs[s]; w++)
+    {
+        // configs in this word that are not blocked by a placed ship
+        uint64_t candidates = solver->shipConfigBits[s][w] & ~blocked[s][w];
+
+        while (candidates)
+        {
+            int c = w * 64 + __builtin_ctzll(candidates);
+            candidates &= candidates - 1;
+
+            if (depth == 1 && state->validConfigs > 0 && deadlinePassed(solver))
+                return;
+
+            placeConfig(solver, state, depth, c, occupied, blocked);
+        }
+    }
+
+    return;
+}
+
+/**
+ * Places ship searchOrder[depth] in config c (which must not collide
+ * with the ships already placed) and searches the ships after it.
+ * A partial placement is abandoned when
+ * 1. a ship not yet placed has no config left that avoids the placed ships
+ * 2. the ships not yet placed can't cover the remaining hit squares
+ * 
+ * @param state where valid boards are recorded
+ * @param depth # of ships already placed
+ * @param c config index of ship searchOrder[depth]
+ * @param occupied squares covered by the ships already placed
+ * @param blocked for each ship, the configs colliding with a placed ship
+ */
+static void placeConfig(struct solver *solver, struct searchState *state, int depth, int c, bitboard occupied, uint64_t blocked[5][CONFIG_WORDS])
+{
+    int s = solver->searchOrder[depth];
+
+    bitboard newOccupied = occupied | shipConfigMasks[s][c];
+    bitboard remainingHits = solver->hitMask & ~newOccupied;
+    state->configs[s] = c;
+    state->nodes++;
+    TRACE_COUNT(state->counters.candidates, 1);
+
+    if (depth + 1 == solver->numSearchShips)
+    {
+        // every ship is placed, the board is valid if all hits are covered
+        state->tested++;
+        if (remainingHits == 0)
+        {
+            state->validConfigs++;
+            for (int d = 0; d < solver->numSearchShips; d++)
+                state->frequencies[solver->searchOrder[d]][state->configs[solver->searchOrder[d]]]++;
+            if (state->keepBoards)
+                keepSearchBoard(state);
+            TRACE_COUNT(state->counters.accepted, 1);
+        }
+        else
+            TRACE_COUNT(state->counters.uncoveredHits, 1);
+        return;
+    }
+
+    uint64_t newBlocked[5][CONFIG_WORDS];
+    if (canExtend(solver, depth, c, remainingHits, blocked, newBlocked))
+        searchConfigs(solver, state, depth + 1, newOccupied, newBlocked);
+    else
+    {
+        // (which of canExtend's checks failed)
+        TRACE_COUNT(state->counters.uncoveredHits, hitsOutOfReach(solver, depth, remainingHits));
+        TRACE_COUNT(state->counters.collisions, !hitsOutOfReach(solver, depth, remainingHits));
+    }
+
+    return;
+}
+
+/**
+ * Counts the boards completed by the last ship (searchOrder[depth]) given
+ * the ships already placed, without placing it in each config: its
+ * configs that complete a board are the ones not blocked by a placed
+ * ship and covering every remaining hit, which is the AND of a few config
+ * bitsets (shipConfigBits, blocked and shipSquareConfigs for each hit).
+ * 
+ * @param state where valid boards are recorded
+ * @param depth # of ships already placed
+ * @param occupied squares covered by the ships already placed
+ * @param blocked for each ship, the configs colliding with a placed ship
+ */
+static void countLastShip(struct solver *solver, struct searchState *state, int depth, bitboard occupied, uint64_t blocked[5][CONFIG_WORDS])
+{
+    int s = solver->searchOrder[depth];
+
+    uint64_t completing[CONFIG_WORDS];
+    coveringConfigs(solver, s, solver->hitMask & ~occupied, completing);
+    state->nodes++;
+
+    long long count = 0, numAvailable = 0;
+    for (int w = 0; w < CONFIG_WORDS; w++)
+    {
+        uint64_t available = solver->shipConfigBits[s][w] & ~blocked[s][w];
+        numAvailable += __builtin_popcountll(available);
+        TRACE_COUNT(state->counters.candidates, __builtin_popcountll(solver->shipConfigBits[s][w]));
+        TRACE_COUNT(state->counters.collisions, __builtin_popcountll(solver->shipConfigBits[s][w] & blocked[s][w]));
+
+        completing[w] &= available;
+        count += __builtin_popcountll(completing[w]);
+
+        for (uint64_t bits = completing[w]; bits; bits &= bits - 1)
+        {
+            int c = w * 64 + __builtin_ctzll(bits);
+            state->frequencies[s][c]++;
+            if (state->keepBoards)
+            {
+                state->configs[s] = c;
+                keepSearchBoard(state);
+            }
+        }
+    }
+
+    state->tested += numAvailable;
+    state->validConfigs += count;
+    for (int d = 0; d < depth; d++)
+        state->frequencies[solver->searchOrder[d]][state->configs[solver->searchOrder[d]]] += count;
+
+    TRACE_COUNT(state->counters.uncoveredHits, numAvailable - count);
+    TRACE_COUNT(state->counters.accepted, count);
+
+    return;
+}
+
+/**
+ * Checks if ship searchOrder[depth] in config c can still lead to a
+ * valid board once the ships after it are placed, and blocks the
+ * configs of those ships that collide with it
+ * 
+ * The twin ships (1 and 2, both of length 3) have the same configs, so
+ * each board has a copy with the two swapped; when the first of them is
+ * placed in config c, the second is kept to configs above c, and only
+ * one of the two copies is searched (storeFrequencies counts it twice).
+ * 
+ * @param depth # of ships already placed
+ * @param c config index of ship searchOrder[depth]
+ * @param remainingHits hit squares not covered by the ships placed so far (including this one)
+ * @param blocked for each ship, the configs colliding with a ship placed before this one
+ * @param newBlocked filled with blocked plus the configs colliding with this one
+ * @return 0 if the ships left can't cover the remaining hits or one of
+ *         them has no config left, 1 otherwise
+ */
+static int canExtend(struct solver *solver, int depth, int c, bitboard remainingHits, uint64_t blocked[5][CONFIG_WORDS], uint64_t newBlocked[5][CONFIG_WORDS])
+{
+    int s = solver->searchOrder[depth];
+
+    if (hitsOutOfReach(solver, depth, remainingHits))
+        return 0;
+
+    // block the configs of the ships left that collide with this one
+    // (and, if this is one of the twin ships, the other one's configs up to c)
+    for (int d = depth + 1; d < solver->numSearchShips; d++)
+    {
+        int t = solver->searchOrder[d];
+        int twin = isTwinShip(s) && isTwinShip(t);
+        uint64_t available = 0;
+        for (int v = 0; v < CONFIG_WORDS; v++)
+        {
+            newBlocked[t][v] = blocked[t][v] | shipCollisions[s][t][c][v];
+            if (twin)
+                newBlocked[t][v] |= configsUpTo(c, v);
+            available |= solver->shipConfigBits[t][v] & ~newBlocked[t][v];
+        }
+        if (available == 0)
+            return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Returns 1 if the ships after searchOrder[depth] can't cover the
+ * remaining hits (some hit is out of their reach, or there are more hits
+ * than squares in them), 0 otherwise
+ */
+static inline int hitsOutOfReach(struct solver *solver, int depth, bitboard remainingHits)
+{
+    return (remainingHits & ~solver->searchCoverage[depth + 1]) != 0 ||
+           bitboardCount(remainingHits) > solver->searchLength[depth + 1];
+}
+
+/**
+ * Counts all remaining configs exactly, for states too large for
+ * bruteForceTestConfigs (meet-in-the-middle)
+ * 
+ * The unsunk ships are split into two groups and every placement of each
+ * group (its ships not overlapping each other) is listed; there are only
+ * ~27k and ~1.9M of them on an empty board, against ~3e10 valid boards.
+ * A placement a of one group and b of the other make a valid board if
+ * they don't overlap and b covers the hits a doesn't. For each square,
+ * indexGroup keeps a bitset of the placements of a group covering it, so
+ * the placements b joining a given a are found 64 at a time:
+ *   ~(OR of the bitsets of the squares of a) & (AND of the bitsets of the hits not in a)
+ * 
+ * Each placement a is credited with the # of placements joining it,
+ * which gives exact frequencies for the ships of its group; the same
+ * join is then run the other way around for the ships of the other group.
+ * Rows are split into chunks of JOIN_CHUNK across numThreads threads.
+ * 
+ * Either group may be empty (it then has one placement, with no ships).
+ * 
+ * @return the # of valid boards, or -1 if the placements or bitsets
+ *         couldn't be allocated (nothing is counted then)
+ */
+static long long joinTestConfigs(struct solver *solver)
+{
+    prepareSearch(solver);
+
+    // the ships with the most configs go in the smaller group, which
+    // keeps the larger group (and its bitsets) as small as possible;
+    // the twin ships always go in the same group, so that only one of
+    // their orders is listed (in the smaller group if they fit)
+    struct shipGroup groups[2];
+    memset(groups, 0, sizeof(groups));
+    int twins = twinShipsUnsunk(solver);
+    if (twins)
+    {
+        struct shipGroup *group = &groups[solver->numSearchShips / 2 < 2];
+        group->ships[group->numShips++] = 1;
+        group->ships[group->numShips++] = 2;
+    }
+    for (int d = 0; d < solver->numSearchShips; d++)
+    {
+        int s = solver->searchOrder[solver->numSearchShips - 1 - d];
+        if (twins && isTwinShip(s))
+            continue;
+
+        struct shipGroup *group = &groups[groups[0].numShips >= solver->numSearchShips / 2];
+        group->ships[group->numShips++] = s;
+    }
+
+    int failed = 0;
+    for (int g = 0; g < 2 && !failed; g++)
+    {
+        int capacity = 1024;
+        unsigned char configs[5];
+        uint64_t blocked[5][CONFIG_WORDS] = {{0}};
+
+        TRACE_SPAN_BEGIN(groupStart);
+        groups[g].placements = malloc((size_t)capacity * groups[g].numShips);
+        failed = (groups[g].placements == NULL && groups[g].numShips > 0) ||
+                 enumerateGroup(solver, &groups[g], 0, configs, blocked, &capacity) ||
+                 indexGroup(&groups[g]);
+        TRACE_SPAN_END(solver->trace, groupStart, "enumerateGroup", 0);
+    }
+
+    struct searchState *states = NULL;
+    if (!failed)
+    {
+        if (DEBUG)
+            solverLog(solver, "Joining %d placements of %d ship(s) with %d placements of %d ship(s)\n",
+                   groups[0].numPlacements, groups[0].numShips, groups[1].numPlacements, groups[1].numShips);
+
+        states = calloc(solver->options.numThreads, sizeof(struct searchState));
+        failed = states == NULL;
+    }
+
+    // (with no placements for a group, there are no valid boards to count)
+    for (int pass = 0; pass < 2 && !failed && groups[0].numPlacements > 0 && groups[1].numPlacements > 0; pass++)
+    {
+        struct joinPass join;
+        join.solver = solver;
+        join.rows = &groups[pass];
+        join.columns = &groups[1 - pass];
+        join.states = states;
+        join.countBoards = pass == 0;
+        join.conflicts = malloc((size_t)solver->options.numThreads * (join.rows->numShips + 1) * join.columns->words * sizeof(uint64_t));
+        if (join.conflicts == NULL)
+        {
+            failed = 1;
+            break;
+        }
+
+        runParallel(solver->options.numThreads, (join.rows->numPlacements + JOIN_CHUNK - 1) / JOIN_CHUNK, joinTask, &join);
+
+        free(join.conflicts);
+    }
+
+    long long validConfigs = failed ? -1 : storeFrequencies(solver, states, solver->options.numThreads);
+    free(states);
+
+    for (int g = 0; g < 2; g++)
+    {
+        free(groups[g].placements);
+        free(groups[g].squarePlacements);
+    }
+
+    return validConfigs;
+}
+
+/**
+ * Adds every placement of the group's ships from the given depth on to
+ * the group's placements (growing the list as needed)
+ * 
+ * @param group the group of ships
+ * @param depth # of the group's ships already placed
+ * @param configs config index of each ship already placed
+ * @param blocked for each ship, the configs colliding with a placed ship
+ * @param capacity # of placements the list has room for
+ * @return 0 on success, 1 if the list couldn't be grown (it's left as it was)
+ */
+static int enumerateGroup(struct solver *solver, struct shipGroup *group, int depth, unsigned char configs[5], uint64_t blocked[5][CONFIG_WORDS], int *capacity)
+{
+    if (depth == group->numShips)
+    {
+        if (group->numPlacements == *capacity)
+        {
+            unsigned char *placements = realloc(group->placements, (size_t)*capacity * 2 * group->numShips);
+            if (placements == NULL)
+                return 1;
+            group->placements = placements;
+            *capacity *= 2;
+        }
+
+        memcpy(group->placements + (size_t)group->numPlacements * group->numShips, configs, group->numShips);
+        group->numPlacements++;
+        return 0;
+    }
+
+    int s = group->ships[depth];
+
+    for (int w = 0; w * 64 < numShipConfigs[s]; w++)
+    {
+        uint64_t candidates = solver->shipConfigBits[s][w] & ~blocked[s][w];
+
+        while (candidates)
+        {
+            int c = w * 64 + __builtin_ctzll(candidates);
+            candidates &= candidates - 1;
+
+            // block the configs of the ships left that collide with this one
+            // (and, like canExtend, the other twin ship's configs up to c)
+            uint64_t newBlocked[5][CONFIG_WORDS];
+            for (int d = depth + 1; d < group->numShips; d++)
+            {
+                int t = group->ships[d];
+                int twin = isTwinShip(s) && isTwinShip(t);
+                for (int v = 0; v < CONFIG_WORDS; v++)
+                {
+                    newBlocked[t][v] = blocked[t][v] | shipCollisions[s][t][c][v];
+                    if (twin)
+                        newBlocked[t][v] |= configsUpTo(c, v);
+                }
+            }
+
+            configs[depth] = c;
+            if (enumerateGroup(solver, group, depth + 1, configs, newBlocked, capacity))
+                return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Builds the group's squarePlacements: for each square, the bitset of
+ * the placements covering it
+ * 
+ * @return 0 on success, 1 if the bitsets couldn't be allocated
+ */
+static int indexGroup(struct shipGroup *group)
+{
+    group->words = (group->numPlacements + 63) / 64;
+    group->squarePlacements = calloc((size_t)BOARD_SIDELENGTH * BOARD_SIDELENGTH * group->words, sizeof(uint64_t));
+    if (group->squarePlacements == NULL && group->words > 0)
+        return 1;
+
+    for (int p = 0; p < group->numPlacements; p++)
+    {
+        unsigned char *configs = group->placements + (size_t)p * group->numShips;
+
+        bitboard squares = 0;
+        for (int d = 0; d < group->numShips; d++)
+            squares |= shipConfigMasks[group->ships[d]][configs[d]];
+
+        while (squares)
+        {
+            uint64_t low = (uint64_t)squares;
+            int square = low ? __builtin_ctzll(low) : 64 + __builtin_ctzll((uint64_t)(squares >> 64));
+            squares &= squares - 1;
+
+            group->squarePlacements[(size_t)square * group->words + p / 64] |= (uint64_t)1 << (p % 64);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Joins a chunk of JOIN_CHUNK placements of the rows group with every
+ * placement of the columns group, counting the boards they make into
+ * the thread's searchState
+ * 
+ * Consecutive placements usually share their first ships' configs, so
+ * the columns overlapping the first d ships of the last placement are
+ * kept (in conflicts) and only rebuilt from the first ship that differs.
+ * 
+ * @param task index of the chunk
+ * @param thread index of the thread running the task
+ * @param arg the joinPass
+ */
+static void joinTask(int task, int thread, void *arg)
+{
+    struct joinPass *join = arg;
+    struct solver *solver = join->solver;
+    struct shipGroup *rows = join->rows;
+    struct shipGroup *columns = join->columns;
+    struct searchState *state = join->states + thread;
+
+    int numShips = rows->numShips;
+    int words = columns->words;
+    // conflicts + d * words: the columns overlapping the first d ships (d >= 1),
+    // then room for the columns joining the current placement
+    uint64_t *conflicts = join->conflicts + (size_t)thread * (numShips + 1) * words;
+
+    // the unused bits of the last word, which are never a valid column
+    uint64_t lastWord = columns->numPlacements % 64 ? ((uint64_t)1 << (columns->numPlacements % 64)) - 1 : ~(uint64_t)0;
+
+    // (the join isn't bound by the time budget, but a cancelled move stops)
+    if (moveCancelled(solver))
+        return;
+
+    int first = task * JOIN_CHUNK;
+    int last = first + JOIN_CHUNK < rows->numPlacements ? first + JOIN_CHUNK : rows->numPlacements;
+
+    TRACE_SPAN_BEGIN(spanStart);
+
+    unsigned char *previous = NULL;
+    for (int p = first; p < last; p++)
+    {
+        unsigned char *configs = rows->placements + (size_t)p * numShips;
+
+        bitboard occupied = 0;
+        for (int d = 0; d < numShips; d++)
+            occupied |= shipConfigMasks[rows->ships[d]][configs[d]];
+
+        // bitsets of the squares of the last ship (the columns they rule
+        // out) and of the hits left to the columns (the columns they need)
+        uint64_t *overlapping[5];
+        uint64_t *needed[BOARD_SIDELENGTH * BOARD_SIDELENGTH];
+        int numOverlapping = 0, numNeeded = 0;
+
+        // rebuild the conflicts of the first ships that changed
+        int d = 0;
+        if (previous != NULL)
+            while (d < numShips - 1 && configs[d] == previous[d])
+                d++;
+
+        for (; d < numShips; d++)
+        {
+            bitboard squares = shipConfigMasks[rows->ships[d]][configs[d]];
+            numOverlapping = 0;
+            while (squares)
+            {
+                uint64_t low = (uint64_t)squares;
+                int square = low ? __builtin_ctzll(low) : 64 + __builtin_ctzll((uint64_t)(squares >> 64));
+                squares &= squares - 1;
+                overlapping[numOverlapping++] = columns->squarePlacements + (size_t)square * words;
+            }
+
+            if (d == numShips - 1)
+                break;
+
+            // conflicts of the first d + 1 ships
+            uint64_t *to = conflicts + (size_t)(d + 1) * words;
+            for (int w = 0; w < words; w++)
+            {
+                uint64_t word = d > 0 ? to[w - words] : 0;
+                for (int i = 0; i < numOverlapping; i++)
+                    word |= overlapping[i][w];
+                to[w] = word;
+            }
+        }
+
+        bitboard remainingHits = solver->hitMask & ~occupied;
+        while (remainingHits)
+        {
+            uint64_t low = (uint64_t)remainingHits;
+            int square = low ? __builtin_ctzll(low) : 64 + __builtin_ctzll((uint64_t)(remainingHits >> 64));
+            remainingHits &= remainingHits - 1;
+            needed[numNeeded++] = columns->squarePlacements + (size_t)square * words;
+        }
+
+        // the columns joining this placement; the last ship's conflicts
+        // are only needed here, so they go straight into joined
+        uint64_t *joined = conflicts + (size_t)numShips * words;
+        if (numShips > 1)
+            memcpy(joined, conflicts + (size_t)(numShips - 1) * words, words * sizeof(uint64_t));
+        else
+            memset(joined, 0, words * sizeof(uint64_t));
+        for (int i = 0; i < numOverlapping; i++)
+            for (int w = 0; w < words; w++)
+                joined[w] |= overlapping[i][w];
+        for (int w = 0; w < words; w++)
+            joined[w] = ~joined[w];
+        joined[words - 1] &= lastWord;
+        // (columns that don't overlap: the rest collide, and the ones of
+        // these that miss a hit are taken back off once they're known)
+        TRACE_COUNT(state->counters.collisions, join->countBoards ? columns->numPlacements - bitsetPopcount(joined, words) : 0);
+        TRACE_COUNT(state->counters.uncoveredHits, join->countBoards ? bitsetPopcount(joined, words) : 0);
+        for (int i = 0; i < numNeeded; i++)
+            for (int w = 0; w < words; w++)
+                joined[w] &= needed[i][w];
+
+        long long numJoined = bitsetPopcount(joined, words);
+
+        if (join->countBoards)
+        {
+            state->tested += columns->numPlacements;
+            state->validConfigs += numJoined;
+            TRACE_COUNT(state->counters.candidates, columns->numPlacements);
+            TRACE_COUNT(state->counters.accepted, numJoined);
+            TRACE_COUNT(state->counters.uncoveredHits, -numJoined);
+        }
+        for (d = 0; d < numShips; d++)
+            state->frequencies[rows->ships[d]][configs[d]] += numJoined;
+
+        previous = configs;
+    }
+
+    TRACE_SPAN_END(solver->trace, spanStart, join->countBoards ? "joinTask (count)" : "joinTask", thread);
+
+    return;
+}
+
+/**
+ * Given the configs of all 5 ships, tests to see if it is a valid board config
+ * 1. Makes sure no ships are intersecting (using the matrix generated before)
+ * 2. Makes sure all hit squares are covered
+ * 
+ * Sunken ships are skipped: their squares are never part of another
+ * ship's config and are not included in hitMask.
+ * 
+ * @param testedShipConfigs index into shipConfigs for each ship
+ */
+int validConfig(struct solver *solver, int testedShipConfigs[5])
+{
+    return !shipsIntersect(solver, testedShipConfigs) && hitsCovered(solver, testedShipConfigs);
+}
+
+/**
+ * Returns 1 if two of the unsunk ships intersect in the given configs
+ * (using the matrix generated before), 0 otherwise
+ * 
+ * @param testedShipConfigs index into shipConfigs for each ship
+ */
+static int shipsIntersect(struct solver *solver, int testedShipConfigs[5])
+{
+    for (int s1 = 0; s1 < 5; s1++)
+    {
+        if (solver->sunken[s1])
+            continue;
+        for (int s2 = s1 + 1; s2 < 5; s2++)
+        {
+            if (!solver->sunken[s2] && shipConfigsCollide(s1, s2, testedShipConfigs[s1], testedShipConfigs[s2]))
+                return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Returns 1 if the unsunk ships in the given configs cover every hit
+ * (but not on a sunk ship) square, 0 otherwise
+ * 
+ * @param testedShipConfigs index into shipConfigs for each ship
+ */
+static int hitsCovered(struct solver *solver, int testedShipConfigs[5])
+{
+    // Stores which squares are covered by this board configuration
+    bitboard coveredSquares = 0;
+
+    for (int s = 0; s < 5; s++)
+    {
+        if (!solver->sunken[s])
+            coveredSquares |= shipConfigMasks[s][testedShipConfigs[s]];
+    }
+
+    return (solver->hitMask & ~coveredSquares) == 0;
+}
+
+/**
+ * Sums up the counts of several threads and stores the frequency of
+ * each ship config in shipPositionFrequencies (and the # of configs
+ * evaluated in configsEvaluated)
+ * 
+ * While both twin ships are unsunk, every board counted also stands for
+ * the board with the two of them swapped: the twins' frequencies are
+ * summed and every other count (but configsEvaluated, the work actually
+ * done) doubled. This completes the searches, which only count one of
+ * the two (see canExtend); for the samplers it's the same as drawing
+ * each board in both orders.
+ * 
+ * @param states the per-thread searchStates
+ * @param numStates # of searchStates
+ * @return the total # of valid boards
+ */
+static long long storeFrequencies(struct solver *solver, struct searchState *states, int numStates)
+{
+    long long validConfigs = 0;
+    solver->configsEvaluated = 0;
+#if TRACE
+    struct traceCounters counters = {0};
+#endif
+    for (int t = 0; t < numStates; t++)
+    {
+        validConfigs += states[t].validConfigs;
+        solver->configsEvaluated += states[t].tested;
+        TRACE_COUNT(counters.candidates, states[t].counters.candidates);
+        TRACE_COUNT(counters.collisions, states[t].counters.collisions);
+        TRACE_COUNT(counters.uncoveredHits, states[t].counters.uncoveredHits);
+        TRACE_COUNT(counters.accepted, states[t].counters.accepted);
+    }
+    TRACE_COUNTERS(solver->trace, "counters", &counters);
+
+    for (int s = 0; s < 5; s++)
+    {
+        for (int c = 0; c < numShipConfigs[s]; c++)
+        {
+            long long frequency = 0;
+            for (int t = 0; t < numStates; t++)
+                frequency += states[t].frequencies[s][c];
+
+            solver->shipPositionFrequencies[s][c] = frequency;
+        }
+    }
+
+    if (twinShipsUnsunk(solver))
+    {
+        for (int s = 0; s < 5; s++)
+        {
+            if (s == 2)
+                continue;
+            for (int c = 0; c < numShipConfigs[s]; c++)
+            {
+                if (s == 1)
+                    solver->shipPositionFrequencies[1][c] = solver->shipPositionFrequencies[2][c] =
+                        solver->shipPositionFrequencies[1][c] + solver->shipPositionFrequencies[2][c];
+                else
+                    solver->shipPositionFrequencies[s][c] *= 2;
+            }
+        }
+        validConfigs *= 2;
+    }
+
+    return validConfigs;
+}
+
+/**
+ * Now that the frequencies of each ship configuration have been calculated,
+ * this function actually fills out the frequencies of each individual
+ * square on the board and uses these values to find the best move.
+ * 
+ * Finds the square with # of hits closest to t/2
+ */
+int calculateBestMove(struct solver *solver, long long totalTested)
+{
+    long long *moveFrequencies = solver->squareFrequencies;
+
+    for (int i = 0; i < BOARD_SIDELENGTH * BOARD_SIDELENGTH; i++)
+        moveFrequencies[i] = 0;
+
+    for (int s = 0; s < 5; s++)
+    {
+        if (solver->sunken[s])
+            continue;
+
+        int shipLength = shipLengths[s];
+        for (int c = 0; c < numShipConfigs[s]; c++)
+        {
+            long long configFrequency = solver->shipPositionFrequencies[s][c];
+            if (configFrequency <= 0)
+                continue;
+
+            // the squares the config covers (see generateShipConfigs)
+            const unsigned char *squares = shipConfigSquares[s][c];
+            for (int l = 0; l < shipLength; l++)
+                moveFrequencies[squares[l]] += configFrequency;
+        }
+    }
+
+    double targetHits = ((double) totalTested) / 2; // don't worry about truncation
+
+    int bestMove = -1;
+    double bestDifference = HUGE_VAL;
+    bitboard guessed = solver->hitMask | solver->missMask | solver->sunkMask;
+
+    for (int i = 0; i < BOARD_SIDELENGTH * BOARD_SIDELENGTH; i++)
+    {
+        // iterate through all unguessed squares
+        if (!((guessed >> i) & 1))
+        {
+            if (moveFrequencies[i] != 0) {
+                double diff = fabs(moveFrequencies[i] - targetHits);
+                if (diff < bestDifference)
+                {
+                    bestDifference = diff;
+                    bestMove = i;
+                }
+            }
+        }
+    }
+
+    if (DEBUG) {
+        solverLog(solver, "Best difference: %f\n", bestDifference);
+    }
+
+    return bestMove;
+}
+
+int shipLengthFromIndex(int i)
+{
+    if (i >= 0 && i < 5)
+        return shipLengths[i];
+    fprintf(stderr, "%d \n", i);
+    fprintf(stderr, "Something has gone terribly wrong...\n");
+    return 0;
+}
+
+/**
+ * Returns 1 if ship s is one of the twin ships: 1 and 2 both have
+ * length 3, so their configs are the same and they can be swapped
+ */
+static inline int isTwinShip(int s)
+{
+    return s == 1 || s == 2;
+}
+
+/**
+ * Returns 1 if neither twin ship is sunk
+ */
+static inline int twinShipsUnsunk(struct solver *solver)
+{
+    return !solver->sunken[1] && !solver->sunken[2];
+}
+
+/**
+ * Returns word w of the config bitset in which configs 0 to c are set
+ */
+static inline uint64_t configsUpTo(int c, int w)
+{
+    if (c < w * 64)
+        return 0;
+    if (c >= w * 64 + 63)
+        return ~(uint64_t)0;
+    return ((uint64_t)2 << (c - w * 64)) - 1;
+}
+
+/**
+ * Returns the occupancy mask of a ship config
+ * 
+ * @param shipLength length of the ship
+ * @param config config id of the ship (y, x, o)
+ */
+static bitboard configMask(int shipLength, int config)
+{
+    int currentCoord = config / 10;
+    int right = config % 10;
+
+    bitboard mask = 0;
+    for (int l = 0; l < shipLength; l++)
+    {
+        mask |= (bitboard)1 << currentCoord;
+
+        if (right)
+            currentCoord++;
+        else
+            currentCoord += 10;
+    }
+
+    return mask;
+}
+
+/**
+ * Returns the # of squares set in a mask
+ */
+static inline int bitboardCount(bitboard mask)
+{
+    return __builtin_popcountll((uint64_t)mask) + __builtin_popcountll((uint64_t)(mask >> 64));
+}
+
+/**
+ * Returns the wall-clock time in seconds (from an arbitrary starting point)
+ */
+double wallTime(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * Returns 1 if the current move's time budget has run out or the move was
+ * cancelled, 0 otherwise (always 0 without a budget unless cancelled)
+ */
+static int deadlinePassed(struct solver *solver)
+{
+    if (moveCancelled(solver))
+        return 1;
+    return solver->moveDeadline > 0 && wallTime() >= solver->moveDeadline;
+}
+
+/**
+ * Returns 1 if the current move was cancelled (its result is dropped), 0 otherwise
+ */
+static inline int moveCancelled(struct solver *solver)
+{
+    return __atomic_load_n(&solver->cancelled, __ATOMIC_RELAXED);
+}
+
+/**
+ * Returns a random integer in [0, n) (n > 0), scaling a 32-bit draw by n
+ * with a multiply and a shift instead of taking it modulo n (a division
+ * per draw in the samplers' inner loops). Both are biased by at most
+ * n / 2^32, which is negligible for the # of configs or boards drawn from.
+ */
+static inline uint32_t randomBelow(struct mtState *rng, uint32_t n)
+{
+    uint32_t r = (uint32_t)genrand_int32_r(rng);
+    return (uint32_t)(((uint64_t)r * n) >> 32);
+}
+
+/**
+ * Returns the # of bits set in a config bitset
+ */
+static inline int bitsetCount(uint64_t bits[CONFIG_WORDS])
+{
+    int count = 0;
+    for (int w = 0; w < CONFIG_WORDS; w++)
+        count += __builtin_popcountll(bits[w]);
+    return count;
+}
+
+/**
+ * Returns the # of bits set in a bitset of the given # of words
+ * 
+ * Adds up 4 words at a time with a carry-save adder (bit i of ones,
+ * twos and fours holds bit i of the count so far, modulo 8), so the
+ * popcount of the sum is only taken once every 4 words; on targets
+ * without a popcount instruction this is ~3x faster than counting words
+ * one at a time.
+ */
+static long long bitsetPopcount(const uint64_t *bits, int numWords)
+{
+    long long count = 0;
+    uint64_t ones = 0, twos = 0;
+
+    int w = 0;
+    for (; w + 4 <= numWords; w += 4)
+    {
+        uint64_t twosA, twosB, carry;
+
+        // ones + bits[w] + bits[w + 1], carries into twosA
+        carry = ones & bits[w];
+        ones ^= bits[w];
+        twosA = carry | (ones & bits[w + 1]);
+        ones ^= bits[w + 1];
+
+        carry = ones & bits[w + 2];
+        ones ^= bits[w + 2];
+        twosB = carry | (ones & bits[w + 3]);
+        ones ^= bits[w + 3];
+
+        // twos + twosA + twosB, carries into fours
+        uint64_t fours = (twos & twosA) | ((twos ^ twosA) & twosB);
+        twos ^= twosA ^ twosB;
+
+        count += 4 * __builtin_popcountll(fours);
+    }
+    count += 2 * __builtin_popcountll(twos) + __builtin_popcountll(ones);
+
+    for (; w < numWords; w++)
+        count += __builtin_popcountll(bits[w]);
+
+    return count;
+}
+
+/**
+ * Returns the index of the k-th (counting from 0) bit set in a config
+ * bitset, or -1 if fewer than k + 1 bits are set
+ */
+static int bitsetSelect(uint64_t bits[CONFIG_WORDS], int k)
+{
+    for (int w = 0; w < CONFIG_WORDS; w++)
+    {
+        int count = __builtin_popcountll(bits[w]);
+        if (k < count)
+        {
+            uint64_t word = bits[w];
+            for (int i = 0; i < k; i++)
+                word &= word - 1;
+            return w * 64 + __builtin_ctzll(word);
+        }
+        k -= count;
+    }
+    return -1;
+}
+
+/**
+ * Fills a bitset with the configs of ship s that cover every one of the
+ * given squares (all of its configs if there are none)
+ * 
+ * @param s index of the ship
+ * @param squares the squares to cover
+ * @param covering filled with the bitset
+ */
+static void coveringConfigs(struct solver *solver, int s, bitboard squares, uint64_t covering[CONFIG_WORDS])
+{
+    for (int w = 0; w < CONFIG_WORDS; w++)
+        covering[w] = solver->shipConfigBits[s][w];
+
+    while (squares)
+    {
+        uint64_t low = (uint64_t)squares;
+        int square = low ? __builtin_ctzll(low) : 64 + __builtin_ctzll((uint64_t)(squares >> 64));
+        squares &= squares - 1;
+
+        for (int w = 0; w < CONFIG_WORDS; w++)
+            covering[w] &= shipSquareConfigs[s][square][w];
+    }
+
+    return;
+}
@@ -0,0 +1,367 @@
+/**
+ * A small work-stealing pool for running a fixed range of independent
+ * tasks on several threads.
+ * 
+ * The task indices [0, numTasks) are split into one contiguous range per
+ * thread. Each thread takes tasks from the front of its own range, and
+ * once that is empty, steals the back half of the largest range left.
+ * A task runs exactly once, but which thread runs it depends on timing,
+ * so tasks should only use the thread index to pick private scratch
+ * space (not to decide what to compute).
+ * 
+ * For tasks that keep coming in (rather than a range known up front),
+ * a taskQueue keeps a fixed set of threads running tasks from a bounded
+ * FIFO queue; submitting to a full queue waits for room.
+ */
+
+#include "./headers/threadpool.h"
+
+// tasks [next, end) that haven't been taken yet by one thread
+struct taskRange
+{
+    pthread_mutex_t lock;
+    int next;
+    int end;
+};
+
+struct pool
+{
+    int numThreads;
+    struct taskRange *ranges; // one per thread
+    taskFunction task;
+    void *arg;
+};
+
+struct worker
+{
+    struct pool *pool;
+    int index;
+};
+
+/**
+ * Returns the # of online processors (at least 1)
+ */
+int defaultNumThreads(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n < 1 ? 1 : (int)n;
+}
+
+/**
+ * Takes the next task for a thread, stealing from another thread's
+ * range if its own is empty
+ * 
+ * @return the task index, or -1 if there are no tasks left
+ */
+static int takeTask(struct pool *pool, int thread)
+{
+    struct taskRange *own = pool->ranges + thread;
+    int task = -1;
+
+    pthread_mutex_lock(&own->lock);
+    if (own->next < own->end)
+        task = own->next++;
+    pthread_mutex_unlock(&own->lock);
+
+    if (task != -1)
+        return task;
+
+    // own range is empty, find the thread with the most tasks left
+    int victim = -1;
+    int mostLeft = 0;
+    for (int i = 1; i < pool->numThreads; i++)
+    {
+        int t = (thread + i) % pool->numThreads;
+        pthread_mutex_lock(&pool->ranges[t].lock);
+        int left = pool->ranges[t].end - pool->ranges[t].next;
+        pthread_mutex_unlock(&pool->ranges[t].lock);
+
+        if (left > mostLeft)
+        {
+            mostLeft = left;
+            victim = t;
+        }
+    }
+
+    if (victim == -1)
+        return -1;
+
+    // steal the back half of the victim's range (it may have shrunk since)
+    struct taskRange *other = pool->ranges + victim;
+    int stolenBegin, stolenEnd;
+
+    pthread_mutex_lock(&other->lock);
+    stolenEnd = other->end;
+    stolenBegin = other->next + (other->end - other->next) / 2;
+    other->end = stolenBegin;
+    pthread_mutex_unlock(&other->lock);
+
+    if (stolenBegin >= stolenEnd)
+        return takeTask(pool, thread); // lost the race, look again
+
+    pthread_mutex_lock(&own->lock);
+    own->next = stolenBegin + 1;
+    own->end = stolenEnd;
+    pthread_mutex_unlock(&own->lock);
+
+    return stolenBegin;
+}
+
+static void *runWorker(void *arg)
+{
+    struct worker *worker = arg;
+    struct pool *pool = worker->pool;
+
+    int task;
+    while ((task = takeTask(pool, worker->index)) != -1)
+        pool->task(task, worker->index, pool->arg);
+
+    return NULL;
+}
+
+/**
+ * Runs task(i, thread, arg) for every i in [0, numTasks) on numThreads
+ * threads and returns once all of them are done. With 1 thread, the
+ * tasks are run in order on the calling thread, as they are if the pool
+ * can't be allocated. If a thread can't be started, the ones running
+ * (the calling thread at least) steal its tasks.
+ * 
+ * @param numThreads # of threads to use
+ * @param numTasks # of tasks
+ * @param task the function to run for every task
+ * @param arg passed to every task
+ */
+void runParallel(int numThreads, int numTasks, taskFunction task, void *arg)
+{
+    if (numThreads > numTasks)
+        numThreads = numTasks;
+
+    struct pool pool;
+    struct worker *workers = NULL;
+    pthread_t *threads = NULL;
+    pool.ranges = NULL;
+    if (numThreads > 1)
+    {
+        pool.ranges = malloc(numThreads * sizeof(struct taskRange));
+        workers = malloc(numThreads * sizeof(struct worker));
+        threads = malloc(numThreads * sizeof(pthread_t));
+    }
+
+    if (pool.ranges == NULL || workers == NULL || threads == NULL)
+    {
+        free(pool.ranges);
+        free(workers);
+        free(threads);
+        for (int i = 0; i < numTasks; i++)
+            task(i, 0, arg);
+        return;
+    }
+
+    pool.numThreads = numThreads;
+    pool.task = task;
+    pool.arg = arg;
+
+    // split the tasks evenly to start with
+    for (int t = 0; t < numThreads; t++)
+    {
+        pthread_mutex_init(&pool.ranges[t].lock, NULL);
+        pool.ranges[t].next = (int)((long long)numTasks * t / numThreads);
+        pool.ranges[t].end = (int)((long long)numTasks * (t + 1) / numThreads);
+        workers[t].pool = &pool;
+        workers[t].index = t;
+    }
+
+    // the calling thread works as thread 0; the ranges of the threads that
+    // couldn't be started are stolen like any other
+    int numStarted = 1;
+    while (numStarted < numThreads && pthread_create(threads + numStarted, NULL, runWorker, workers + numStarted) == 0)
+        numStarted++;
+    runWorker(workers);
+    for (int t = 1; t < numStarted; t++)
+        pthread_join(threads[t], NULL);
+
+    for (int t = 0; t < numThreads; t++)
+        pthread_mutex_destroy(&pool.ranges[t].lock);
+    free(pool.ranges);
+    free(workers);
+    free(threads);
+
+    return;
+}
+
+// a task waiting in a taskQueue
+struct queuedTask
+{
+    queuedFunction task;
+    void *arg;
+};
+
+struct taskQueue
+{
+    pthread_mutex_t lock;
+    pthread_cond_t notEmpty; // signalled when a task is added (or on shutdown)
+    pthread_cond_t notFull;  // signalled when a task is taken
+    struct queuedTask *tasks; // ring buffer of capacity tasks
+    int capacity;
+    int head;                 // index of the oldest task
+    int size;                 // # of tasks waiting
+    int shuttingDown;         // 1 once taskQueueDestroy has been called
+    int numThreads;
+    pthread_t *threads;
+    struct queueWorker *workers;
+};
+
+struct queueWorker
+{
+    struct taskQueue *queue;
+    int index;
+};
+
+/**
+ * Runs tasks from the queue until it shuts down and is empty
+ */
+static void *runQueueWorker(void *arg)
+{
+    struct queueWorker *worker = arg;
+    struct taskQueue *queue = worker->queue;
+
+    while (1)
+    {
+        pthread_mutex_lock(&queue->lock);
+        while (queue->size == 0 && !queue->shuttingDown)
+            pthread_cond_wait(&queue->notEmpty, &queue->lock);
+
+        if (queue->size == 0)
+        {
+            pthread_mutex_unlock(&queue->lock);
+            return NULL;
+        }
+
+        struct queuedTask task = queue->tasks[queue->head];
+        queue->head = (queue->head + 1) % queue->capacity;
+        queue->size--;
+        pthread_cond_signal(&queue->notFull);
+        pthread_mutex_unlock(&queue->lock);
+
+        task.task(worker->index, task.arg);
+    }
+}
+
+/**
+ * Starts numThreads threads running tasks from a queue of at most
+ * capacity waiting tasks
+ * 
+ * If fewer threads can be started, the queue runs with the ones that were.
+ * 
+ * @param numThreads # of threads
+ * @param capacity max # of tasks waiting to run
+ * @return the queue, or NULL if it couldn't be allocated or no thread
+ *         could be started
+ */
+struct taskQueue *taskQueueCreate(int numThreads, int capacity)
+{
+    struct taskQueue *queue = malloc(sizeof(struct taskQueue));
+    if (queue == NULL)
+        return NULL;
+
+    queue->capacity = capacity < 1 ? 1 : capacity;
+    queue->numThreads = numThreads < 1 ? 1 : numThreads;
+    queue->tasks = malloc(queue->capacity * sizeof(struct queuedTask));
+    queue->threads = malloc(queue->numThreads * sizeof(pthread_t));
+    queue->workers = malloc(queue->numThreads * sizeof(struct queueWorker));
+    if (queue->tasks == NULL || queue->threads == NULL || queue->workers == NULL)
+    {
+        free(queue->tasks);
+        free(queue->threads);
+        free(queue->workers);
+        free(queue);
+        return NULL;
+    }
+
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->notEmpty, NULL);
+    pthread_cond_init(&queue->notFull, NULL);
+    queue->head = 0;
+    queue->size = 0;
+    queue->shuttingDown = 0;
+
+    int numStarted = 0;
+    for (int t = 0; t < queue->numThreads; t++)
+    {
+        queue->workers[t].queue = queue;
+        queue->workers[t].index = t;
+        if (pthread_create(queue->threads + t, NULL, runQueueWorker, queue->workers + t) != 0)
+            break;
+        numStarted++;
+    }
+    queue->numThreads = numStarted;
+    if (numStarted == 0)
+    {
+        // (taskQueueDestroy has no thread to join)
+        taskQueueDestroy(queue);
+        return NULL;
+    }
+
+    return queue;
+}
+
+/**
+ * Adds a task to the queue, waiting for room if it is full; the task
+ * is later called with the index of the thread running it and arg
+ * 
+ * @return the # of tasks that were waiting ahead of it
+ */
+int taskQueueSubmit(struct taskQueue *queue, queuedFunction task, void *arg)
+{
+    pthread_mutex_lock(&queue->lock);
+    while (queue->size == queue->capacity)
+        pthread_cond_wait(&queue->notFull, &queue->lock);
+
+    int ahead = queue->size;
+    struct queuedTask *slot = queue->tasks + (queue->head + queue->size) % queue->capacity;
+    slot->task = task;
+    slot->arg = arg;
+    queue->size++;
+
+    pthread_cond_signal(&queue->notEmpty);
+    pthread_mutex_unlock(&queue->lock);
+
+    return ahead;
+}
+
+/**
+ * Returns the # of tasks waiting to run (not counting the running ones)
+ */
+int taskQueueDepth(struct taskQueue *queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    int size = queue->size;
+    pthread_mutex_unlock(&queue->lock);
+
+    return size;
+}
+
+/**
+ * Runs every task left in the queue, then stops the threads and frees
+ * the queue (no task may be submitted once this is called)
+ */
+void taskQueueDestroy(struct taskQueue *queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    queue->shuttingDown = 1;
+    pthread_cond_broadcast(&queue->notEmpty);
+    pthread_mutex_unlock(&queue->lock);
+
+    for (int t = 0; t < queue->numThreads; t++)
+        pthread_join(queue->threads[t], NULL);
+
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->notEmpty);
+    pthread_cond_destroy(&queue->notFull);
+    free(queue->tasks);
+    free(queue->threads);
+    free(queue->workers);
+    free(queue);
+
+    return;
+}
@@ -0,0 +1,197 @@
+/**
+ * Low-overhead event buffer for profiling the move generator, exported
+ * in the Chrome trace event format (load the file in chrome://tracing
+ * or https://ui.perfetto.dev).
+ * 
+ * Every solver has its own fixed-size buffer (a speculative move records
+ * into its copy's, which the solver takes over with the move), so games
+ * played side by side don't mix their events. A slot is claimed with one
+ * atomic add, so any thread of a move can record without locking, and
+ * events past the end of the buffer are dropped (and counted, with a
+ * warning the first time). Nothing is printed until traceExport is
+ * called, which the clients do after each move.
+ * 
+ * Only used when the program is built with TRACE (see trace.h).
+ */
+
+#include "./headers/trace.h"
+
+#define TRACE_BUFFER_SIZE 65536 // max # of events between exports
+
+struct traceEvent
+{
+    const char *name;
+    char phase;                       // 'X' for a span, 'C' for counters
+    int thread;
+    double start;                     // traceNow() at the start
+    double duration;                  // µs (spans only)
+    struct traceCounters counters;    // (counters only)
+};
+
+struct traceBuffer
+{
+    // (malloc'd, so only the pages of the events recorded are touched)
+    struct traceEvent *events; // TRACE_BUFFER_SIZE of them
+    int numEvents;
+    int numDropped;
+    int droppedWarned; // 1 once the warning about dropped events is out
+};
+
+/**
+ * Creates an empty buffer
+ * 
+ * @return the buffer, or NULL if it couldn't be allocated
+ */
+struct traceBuffer *traceBufferCreate(void)
+{
+    struct traceBuffer *buffer = malloc(sizeof(struct traceBuffer));
+    if (buffer == NULL)
+        return NULL;
+
+    buffer->events = malloc(TRACE_BUFFER_SIZE * sizeof(struct traceEvent));
+    if (buffer->events == NULL)
+    {
+        free(buffer);
+        return NULL;
+    }
+    buffer->numEvents = 0;
+    buffer->numDropped = 0;
+    buffer->droppedWarned = 0;
+
+    return buffer;
+}
+
+/**
+ * Frees a buffer (NULL is ignored)
+ */
+void traceBufferDestroy(struct traceBuffer *buffer)
+{
+    if (buffer == NULL)
+        return;
+
+    free(buffer->events);
+    free(buffer);
+}
+
+/**
+ * Returns the time in µs (from an arbitrary starting point)
+ */
+double traceNow(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+/**
+ * Claims a slot in a buffer, or returns NULL if it is full (or there is
+ * no buffer)
+ */
+static struct traceEvent *claimEvent(struct traceBuffer *buffer)
+{
+    if (buffer == NULL)
+        return NULL;
+
+    int i = __atomic_fetch_add(&buffer->numEvents, 1, __ATOMIC_RELAXED);
+    if (i >= TRACE_BUFFER_SIZE)
+    {
+        __atomic_fetch_add(&buffer->numDropped, 1, __ATOMIC_RELAXED);
+        if (!__atomic_exchange_n(&buffer->droppedWarned, 1, __ATOMIC_RELAXED))
+            fprintf(stderr, "Trace buffer full, dropping events until the next export\n");
+        return NULL;
+    }
+    return &buffer->events[i];
+}
+
+/**
+ * Records a span that started at the given time and ends now
+ * 
+ * @param buffer the buffer to record it in (NULL to drop it)
+ * @param name name of the span (must outlive the export)
+ * @param thread index of the thread it ran on
+ * @param start traceNow() at the start of the span
+ */
+void traceSpan(struct traceBuffer *buffer, const char *name, int thread, double start)
+{
+    double end = traceNow();
+    struct traceEvent *event = claimEvent(buffer);
+    if (event == NULL)
+        return;
+
+    event->name = name;
+    event->phase = 'X';
+    event->thread = thread;
+    event->start = start;
+    event->duration = end - start;
+}
+
+/**
+ * Records the values of a set of counters at the current time
+ * 
+ * @param buffer the buffer to record them in (NULL to drop them)
+ * @param name name of the set (must outlive the export)
+ * @param counters the counters
+ */
+void traceSnapshot(struct traceBuffer *buffer, const char *name, struct traceCounters *counters)
+{
+    struct traceEvent *event = claimEvent(buffer);
+    if (event == NULL)
+        return;
+
+    event->name = name;
+    event->phase = 'C';
+    event->thread = 0;
+    event->start = traceNow();
+    event->counters = *counters;
+}
+
+/**
+ * Writes the events recorded in a buffer since its last export to a
+ * Chrome trace JSON file and clears it (no thread may be recording)
+ * 
+ * @param path the file to write
+ * @return 0 on success, 1 if there is no buffer or the file couldn't be
+ *         written
+ */
+int traceExport(struct traceBuffer *buffer, const char *path)
+{
+    if (buffer == NULL)
+        return 1;
+
+    struct traceEvent *events = buffer->events;
+    int n = buffer->numEvents < TRACE_BUFFER_SIZE ? buffer->numEvents : TRACE_BUFFER_SIZE;
+    double origin = n > 0 ? events[0].start : 0;
+    for (int i = 1; i < n; i++)
+    {
+        if (events[i].start < origin)
+            origin = events[i].start;
+    }
+
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+        return 1;
+
+    fprintf(file, "{\"traceEvents\": [\n");
+    for (int i = 0; i < n; i++)
+    {
+        struct traceEvent *event = &events[i];
+        fprintf(file, "  {\"name\": \"%s\", \"ph\": \"%c\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f",
+                event->name, event->phase, event->thread, event->start - origin);
+        if (event->phase == 'X')
+            fprintf(file, ", \"dur\": %.3f}", event->duration);
+        else
+            fprintf(file, ", \"args\": {\"candidates\": %lld, \"collisions\": %lld, \"uncoveredHits\": %lld, \"accepted\": %lld}}",
+                    event->counters.candidates, event->counters.collisions,
+                    event->counters.uncoveredHits, event->counters.accepted);
+        fprintf(file, ",\n");
+    }
+    // (the metadata event also avoids a trailing comma)
+    fprintf(file, "  {\"name\": \"droppedEvents\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"count\": %d}}\n]}\n", buffer->numDropped);
+    fclose(file);
+
+    buffer->numEvents = 0;
+    buffer->numDropped = 0;
+    buffer->droppedWarned = 0;
+
+    return 0;
+}